@@ -0,0 +1,139 @@
+// Builders for synthetic KNXnet/IP datagrams
+
+var ServiceConnectRequest      = 0x0205;
+var ServiceConnectResponse     = 0x0206;
+var ServiceConnStateRequest    = 0x0207;
+var ServiceConnStateResponse   = 0x0208;
+var ServiceDisconnectRequest   = 0x0209;
+var ServiceDisconnectResponse  = 0x020A;
+var ServiceTunnelRequest       = 0x0420;
+var ServiceTunnelResponse      = 0x0421;
+var ServiceRoutingIndication   = 0x0530;
+
+var LDataRequest               = 0x11;
+var LDataIndication            = 0x29;
+var LDataConfirmation          = 0x2E;
+
+function header(service, body) {
+	var length = 6 + body.length;
+	var msg = Buffer.alloc(length);
+
+	msg[0] = 0x06;
+	msg[1] = 0x10;
+	msg.writeUInt16BE(service, 2);
+	msg.writeUInt16BE(length, 4);
+	body.copy(msg, 6);
+
+	return msg;
+}
+
+// Host protocol address information for UDP over IPv4
+function hpai(addr, port) {
+	var buf = Buffer.alloc(8);
+
+	buf[0] = 8;
+	buf[1] = 1;
+	buf.writeUInt32BE(addr >>> 0, 2);
+	buf.writeUInt16BE(port, 6);
+
+	return buf;
+}
+
+// L_Data frame carrying a group value write of 'payload'. Payloads of a single byte holding no
+// more than 6 bits are merged into the APCI like the bus does.
+function ldata(service, source, destination, payload, group) {
+	var short = payload.length == 1 && payload[0] < 64;
+	var npduLength = short ? 1 : payload.length + 1;
+	var frame = Buffer.alloc(9 + npduLength);
+
+	frame[0] = service;
+	frame[1] = 0;
+	frame[2] = 0xBC;
+	frame[3] = (group === false ? 0x00 : 0x80) | 0x60;
+	frame.writeUInt16BE(source, 4);
+	frame.writeUInt16BE(destination, 6);
+	frame[8] = npduLength;
+	frame[9] = 0x00;
+	frame[10] = 0x80 | (short ? payload[0] : 0);
+
+	if (!short)
+		payload.copy(frame, 11);
+
+	return frame;
+}
+
+function routingIndication(source, destination, payload, group) {
+	return header(ServiceRoutingIndication, ldata(LDataIndication, source, destination, payload, group));
+}
+
+function tunnelRequest(channel, seqNumber, frame) {
+	var body = Buffer.alloc(4 + frame.length);
+
+	body[0] = 4;
+	body[1] = channel;
+	body[2] = seqNumber & 255;
+	body[3] = 0;
+	frame.copy(body, 4);
+
+	return header(ServiceTunnelRequest, body);
+}
+
+function tunnelResponse(channel, seqNumber, status) {
+	return header(ServiceTunnelResponse, Buffer.from([4, channel, seqNumber & 255, status || 0]));
+}
+
+function connectResponse(channel, status, addr, port, individual) {
+	var crd = Buffer.from([4, 4, (individual >> 8) & 255, individual & 255]);
+
+	return header(ServiceConnectResponse, Buffer.concat([
+		Buffer.from([channel, status]),
+		hpai(addr, port),
+		crd
+	]));
+}
+
+function connStateResponse(channel, status) {
+	return header(ServiceConnStateResponse, Buffer.from([channel, status]));
+}
+
+function disconnectRequest(channel, addr, port) {
+	return header(ServiceDisconnectRequest, Buffer.concat([Buffer.from([channel, 0]), hpai(addr, port)]));
+}
+
+function disconnectResponse(channel, status) {
+	return header(ServiceDisconnectResponse, Buffer.from([channel, status]));
+}
+
+// Splits a datagram into service and body, yields null for anything that is not KNXnet/IP
+function parse(msg) {
+	if (msg.length < 6 || msg[0] != 0x06 || msg[1] != 0x10 || msg.readUInt16BE(4) != msg.length)
+		return null;
+
+	return {service: msg.readUInt16BE(2), body: msg.slice(6)};
+}
+
+module.exports = {
+	ServiceConnectRequest:     ServiceConnectRequest,
+	ServiceConnectResponse:    ServiceConnectResponse,
+	ServiceConnStateRequest:   ServiceConnStateRequest,
+	ServiceConnStateResponse:  ServiceConnStateResponse,
+	ServiceDisconnectRequest:  ServiceDisconnectRequest,
+	ServiceDisconnectResponse: ServiceDisconnectResponse,
+	ServiceTunnelRequest:      ServiceTunnelRequest,
+	ServiceTunnelResponse:     ServiceTunnelResponse,
+	ServiceRoutingIndication:  ServiceRoutingIndication,
+
+	LDataRequest:              LDataRequest,
+	LDataIndication:           LDataIndication,
+	LDataConfirmation:         LDataConfirmation,
+
+	ldata:                     ldata,
+	routingIndication:         routingIndication,
+	tunnelRequest:             tunnelRequest,
+	tunnelResponse:            tunnelResponse,
+	connectResponse:           connectResponse,
+	connStateResponse:         connStateResponse,
+	disconnectRequest:         disconnectRequest,
+	disconnectResponse:        disconnectResponse,
+	parse:                     parse
+};
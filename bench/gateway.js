@@ -0,0 +1,396 @@
+// Stand-in for a KNXnet/IP gateway which serves tunnelling connections and joins a routing group on
+// this host. Tunnelled frames and routing indications are put on a simulated TP line which carries
+// at most 'lineRate' telegrams per second.
+//
+//   node bench/gateway.js [--port=3671] [--ack-delay=0] [--loss=0] [--line-rate=0]
+//                         [--connection-timeout=120000] [--conn-state-loss=0] [--channels=4]
+//                         [--group=224.0.23.12] [--routing-rate=0]
+//
+// Rates of zero mean unlimited, respectively off for '--routing-rate'. Loss rates are
+// probabilities between 0 and 1.
+
+var EventEmitter = require("events");
+var dgram        = require("dgram");
+var datagrams    = require("./datagrams.js");
+
+// Status codes of connection responses
+var StatusNoError            = 0x00;
+var StatusConnectionId       = 0x21;
+var StatusNoMoreConnections  = 0x24;
+
+function Gateway(options) {
+	EventEmitter.prototype.constructor.call(this);
+
+	options = options || {};
+
+	this.ackDelay          = options.ackDelay || 0;
+	this.loss              = options.loss || 0;
+	this.lineRate          = options.lineRate || 0;
+	this.lineQueueLimit    = options.lineQueue || 256;
+	this.connectionTimeout = options.connectionTimeout || 120000;
+	this.connStateLoss     = options.connStateLoss || 0;
+	this.maxChannels       = options.channels || 4;
+	this.group             = options.group || "224.0.23.12";
+	this.routingRate       = options.routingRate || 0;
+
+	this.channels = {};
+	this.line = [];
+	this.lineTimer = null;
+	this.routingTimer = null;
+	this.routingSeq = 0;
+
+	this.stats = {
+		connects:          0,
+		rejectedConnects:  0,
+		disconnects:       0,
+		timeouts:          0,
+		tunnelRequests:    0,
+		duplicates:        0,
+		lost:              0,
+		acks:              0,
+		confirmations:     0,
+		clientAcks:        0,
+		connStateRequests: 0,
+		connStateIgnored:  0,
+		routingReceived:   0,
+		routingSent:       0,
+		lineSent:          0,
+		lineDropped:       0,
+		linePeak:          0
+	};
+}
+
+Gateway.prototype.__proto__ = EventEmitter.prototype;
+
+Gateway.prototype.listen = function (port, done) {
+	this.sock = dgram.createSocket({type: "udp4", reuseAddr: true});
+	this.sock.on("message", this.handle.bind(this));
+	this.sock.on("error", this.emit.bind(this, "error"));
+
+	this.sock.bind(port, "127.0.0.1", function () {
+		this.port = this.sock.address().port;
+
+		// Routing traffic is looped back so clients on this host see it
+		this.routing = dgram.createSocket({type: "udp4", reuseAddr: true});
+		this.routing.on("message", this.handleRouting.bind(this));
+		this.routing.on("error", this.emit.bind(this, "error"));
+
+		this.routing.bind(this.port, function () {
+			this.routing.addMembership(this.group);
+			this.routing.setMulticastLoopback(true);
+
+			if (this.routingRate > 0)
+				this.routingTimer = setInterval(this.emitIndications.bind(this), 10);
+
+			this.routingStarted = Date.now();
+			if (done) done(this.port);
+		}.bind(this));
+	}.bind(this));
+};
+
+Gateway.prototype.close = function () {
+	for (var id in this.channels)
+		clearTimeout(this.channels[id].timer);
+
+	clearInterval(this.routingTimer);
+
+	if (this.lineRate > 0)
+		clearTimeout(this.lineTimer);
+	else
+		clearImmediate(this.lineTimer);
+
+	this.channels = {};
+	this.sock.close();
+	this.routing.close();
+};
+
+Gateway.prototype.send = function (msg, addr, port) {
+	this.sock.send(msg, 0, msg.length, port, addr);
+};
+
+Gateway.prototype.lost = function () {
+	if (this.loss > 0 && Math.random() < this.loss) {
+		this.stats.lost++;
+		return true;
+	}
+
+	return false;
+};
+
+////////////////
+// Tunnelling //
+////////////////
+
+Gateway.prototype.handle = function (msg, rinfo) {
+	var packet = datagrams.parse(msg);
+	if (!packet) return;
+
+	switch (packet.service) {
+		case datagrams.ServiceConnectRequest:
+			this.handleConnect(packet.body, rinfo);
+			break;
+
+		case datagrams.ServiceConnStateRequest:
+			this.handleConnState(packet.body, rinfo);
+			break;
+
+		case datagrams.ServiceDisconnectRequest:
+			this.handleDisconnect(packet.body, rinfo);
+			break;
+
+		case datagrams.ServiceTunnelRequest:
+			if (!this.lost()) this.handleTunnelRequest(packet.body, rinfo);
+			break;
+
+		case datagrams.ServiceTunnelResponse:
+			this.stats.clientAcks++;
+			break;
+	}
+};
+
+// Channels time out unless the client shows signs of life within 'connectionTimeout'
+Gateway.prototype.touch = function (channel) {
+	clearTimeout(channel.timer);
+
+	channel.timer = setTimeout(function () {
+		this.stats.timeouts++;
+		this.closeChannel(channel, true);
+	}.bind(this), this.connectionTimeout);
+};
+
+Gateway.prototype.closeChannel = function (channel, notify) {
+	clearTimeout(channel.timer);
+	delete this.channels[channel.id];
+
+	if (notify)
+		this.send(datagrams.disconnectRequest(channel.id, 0x7F000001, this.port), channel.addr, channel.port);
+};
+
+Gateway.prototype.handleConnect = function (body, rinfo) {
+	var id = 0;
+
+	for (var i = 1; i <= this.maxChannels; i++) {
+		if (!this.channels[i]) {
+			id = i;
+			break;
+		}
+	}
+
+	if (!id) {
+		this.stats.rejectedConnects++;
+		this.send(datagrams.connectResponse(0, StatusNoMoreConnections, 0, 0, 0), rinfo.address, rinfo.port);
+
+		return;
+	}
+
+	var channel = {
+		id:        id,
+		addr:      rinfo.address,
+		port:      rinfo.port,
+		recvSeq:   0,
+		sendSeq:   0,
+		timer:     null
+	};
+
+	this.channels[id] = channel;
+	this.stats.connects++;
+	this.touch(channel);
+
+	this.send(
+		datagrams.connectResponse(id, StatusNoError, 0x7F000001, this.port, 0x11F0 + id),
+		rinfo.address, rinfo.port
+	);
+};
+
+Gateway.prototype.handleConnState = function (body, rinfo) {
+	var channel = this.channels[body[0]];
+	this.stats.connStateRequests++;
+
+	if (this.connStateLoss > 0 && Math.random() < this.connStateLoss) {
+		this.stats.connStateIgnored++;
+		return;
+	}
+
+	if (channel) this.touch(channel);
+
+	this.send(
+		datagrams.connStateResponse(body[0], channel ? StatusNoError : StatusConnectionId),
+		rinfo.address, rinfo.port
+	);
+};
+
+Gateway.prototype.handleDisconnect = function (body, rinfo) {
+	var channel = this.channels[body[0]];
+
+	if (channel) {
+		this.stats.disconnects++;
+		this.closeChannel(channel, false);
+	}
+
+	this.send(
+		datagrams.disconnectResponse(body[0], channel ? StatusNoError : StatusConnectionId),
+		rinfo.address, rinfo.port
+	);
+};
+
+Gateway.prototype.handleTunnelRequest = function (body, rinfo) {
+	var channel = this.channels[body[1]];
+	if (!channel) return;
+
+	var seq = body[2];
+	this.stats.tunnelRequests++;
+	this.touch(channel);
+
+	var ack = datagrams.tunnelResponse(channel.id, seq, StatusNoError);
+
+	// Acknowledgements get lost just like requests do
+	var respond = function () {
+		if (this.lost()) return;
+
+		this.stats.acks++;
+		this.send(ack, channel.addr, channel.port);
+	}.bind(this);
+
+	// A repeated request means our acknowledgement got lost, it must not reach the line twice
+	if (seq == ((channel.recvSeq - 1) & 255)) {
+		this.stats.duplicates++;
+		respond();
+
+		return;
+	}
+
+	if (seq != channel.recvSeq) return;
+	channel.recvSeq = (channel.recvSeq + 1) & 255;
+
+	if (this.ackDelay > 0)
+		setTimeout(respond, this.ackDelay);
+	else
+		respond();
+
+	var frame = Buffer.from(body.slice(body[0]));
+	if (frame[0] == datagrams.LDataRequest)
+		this.enqueue({channel: channel, frame: frame});
+};
+
+//////////
+// Line //
+//////////
+
+Gateway.prototype.enqueue = function (entry) {
+	if (this.line.length >= this.lineQueueLimit) {
+		this.stats.lineDropped++;
+		return;
+	}
+
+	this.line.push(entry);
+	this.stats.linePeak = Math.max(this.stats.linePeak, this.line.length);
+
+	if (!this.lineTimer) this.transmit();
+};
+
+// Puts the next telegram on the line. Tunnel clients learn about it from an L_Data.con.
+Gateway.prototype.transmit = function () {
+	this.lineTimer = null;
+
+	var entry = this.line.shift();
+	if (!entry) return;
+
+	this.stats.lineSent++;
+
+	if (entry.channel && this.channels[entry.channel.id]) {
+		var con = Buffer.from(entry.frame);
+		con[0] = datagrams.LDataConfirmation;
+
+		var channel = entry.channel;
+		this.send(datagrams.tunnelRequest(channel.id, channel.sendSeq, con), channel.addr, channel.port);
+
+		channel.sendSeq = (channel.sendSeq + 1) & 255;
+		this.stats.confirmations++;
+	}
+
+	if (this.line.length == 0) return;
+
+	if (this.lineRate > 0)
+		this.lineTimer = setTimeout(this.transmit.bind(this), 1000 / this.lineRate);
+	else
+		this.lineTimer = setImmediate(this.transmit.bind(this));
+};
+
+/////////////
+// Routing //
+/////////////
+
+Gateway.prototype.handleRouting = function (msg, rinfo) {
+	var packet = datagrams.parse(msg);
+	if (!packet || packet.service != datagrams.ServiceRoutingIndication) return;
+
+	// Our own indications come back through the loop
+	if (packet.body.readUInt16BE(4) == Gateway.RoutingSource) return;
+	if (this.lost()) return;
+
+	this.stats.routingReceived++;
+	this.enqueue({channel: null, frame: packet.body});
+};
+
+// Emits indications from the line to the routing group at 'routingRate' telegrams per second
+Gateway.prototype.emitIndications = function () {
+	var due = Math.floor((Date.now() - this.routingStarted) * this.routingRate / 1000);
+
+	for (; this.stats.routingSent < due; this.stats.routingSent++) {
+		var seq = this.routingSeq++;
+		var payload = Buffer.from([(seq >> 8) & 255, seq & 255]);
+		var msg = datagrams.routingIndication(Gateway.RoutingSource, 0x0800 | (seq & 255), payload);
+
+		this.routing.send(msg, 0, msg.length, this.port, this.group);
+	}
+};
+
+// Source address of the indications emitted by the gateway
+Gateway.RoutingSource = 0x11FE;
+
+module.exports = Gateway;
+
+//////////
+// Main //
+//////////
+
+function parseOptions(argv) {
+	var options = {port: 3671};
+
+	argv.forEach(function (arg) {
+		var match = /^--([a-z-]+)=(.*)$/.exec(arg);
+		if (!match) throw new Error("Unknown argument " + arg);
+
+		var name = match[1].replace(/-([a-z])/g, function (m, c) { return c.toUpperCase(); });
+		options[name] = name == "group" ? match[2] : Number(match[2]);
+	});
+
+	return options;
+}
+
+if (require.main === module) {
+	var options = parseOptions(process.argv.slice(2));
+	var gateway = new Gateway(options);
+
+	gateway.listen(options.port, function (port) {
+		// When forked by the load generator, report back through IPC
+		if (process.send) {
+			process.send({listening: port});
+
+			process.on("message", function (msg) {
+				if (msg.stats) process.send({stats: gateway.stats});
+			});
+
+			process.on("disconnect", function () {
+				gateway.close();
+			});
+		} else {
+			console.log("Gateway listening on 127.0.0.1:" + port + ", routing on " + gateway.group + ":" + port);
+		}
+	});
+
+	process.on("SIGINT", function () {
+		console.log(JSON.stringify(gateway.stats));
+		process.exit(0);
+	});
+}
@@ -0,0 +1,252 @@
+// Load generator for the tunnel and router clients, running against the gateway simulator
+//
+//   node bench/load.js [--mode=tunnel|router] [--duration=5000] [--window=1] [--rate=0]
+//                      [--native] [--worker] [--json] [gateway options]
+//
+// In tunnel mode, '--window' frames are kept queued at all times and the time from queueing a
+// frame until its acknowledgement is recorded. With a window of one that is the bare round trip.
+// In router mode, writes are sent to the routing group at '--rate' telegrams per second (zero
+// means as fast as possible) while the gateway emits '--routing-rate' indications per second.
+// Remaining options, like '--ack-delay', '--loss' or '--line-rate', are passed to the gateway.
+
+var child_process = require("child_process");
+var path          = require("path");
+var knx           = require("../src/knxclient.js");
+var Gateway       = require("./gateway.js");
+
+var options = {mode: "tunnel", duration: 5000, window: 1, rate: 0, native: false, worker: false, json: false};
+var gatewayArgs = ["--port=0"];
+
+process.argv.slice(2).forEach(function (arg) {
+	var match = /^--([a-z-]+)(?:=(.*))?$/.exec(arg);
+	if (!match) throw new Error("Unknown argument " + arg);
+
+	switch (match[1]) {
+		case "mode":     options.mode = match[2]; break;
+		case "duration": options.duration = Number(match[2]); break;
+		case "window":   options.window = Math.max(1, Number(match[2])); break;
+		case "rate":     options.rate = Number(match[2]); break;
+		case "native":   options.native = true; break;
+		case "worker":   options.worker = true; break;
+		case "json":     options.json = true; break;
+		default:         gatewayArgs.push(arg); break;
+	}
+});
+
+function now() {
+	var t = process.hrtime();
+	return t[0] * 1e6 + t[1] / 1e3;
+}
+
+// Percentiles of the recorded samples in microseconds
+function summarize(samples) {
+	if (samples.length == 0) return null;
+
+	samples.sort(function (a, b) { return a - b; });
+
+	function at(p) {
+		return samples[Math.min(samples.length - 1, Math.floor(samples.length * p))];
+	}
+
+	var sum = samples.reduce(function (a, b) { return a + b; }, 0);
+
+	return {
+		count: samples.length,
+		mean:  sum / samples.length,
+		min:   samples[0],
+		p50:   at(0.5),
+		p90:   at(0.9),
+		p99:   at(0.99),
+		p999:  at(0.999),
+		max:   samples[samples.length - 1]
+	};
+}
+
+// Runs the gateway in a process of its own so it does not share the event loop with the client
+function startGateway(done) {
+	var child = child_process.fork(path.join(__dirname, "gateway.js"), gatewayArgs);
+
+	child.once("message", function (msg) {
+		done(child, msg.listening);
+	});
+}
+
+function gatewayStats(child, done) {
+	child.once("message", function (msg) {
+		done(msg.stats);
+	});
+
+	child.send({stats: true});
+}
+
+function report(result) {
+	if (options.json) {
+		process.stdout.write(JSON.stringify(result, null, "\t") + "\n");
+		return;
+	}
+
+	console.log("mode            " + result.mode);
+	console.log("seconds         " + result.seconds.toFixed(3));
+	console.log("frames          " + result.frames);
+	console.log("frames/s        " + result.framesPerSec.toFixed(1));
+
+	if (result.rtt) {
+		console.log(
+			"ack rtt (us)    p50 " + result.rtt.p50.toFixed(0) + "  p90 " + result.rtt.p90.toFixed(0) +
+			"  p99 " + result.rtt.p99.toFixed(0) + "  p99.9 " + result.rtt.p999.toFixed(0) +
+			"  max " + result.rtt.max.toFixed(0)
+		);
+	}
+
+	if (result.received != null) {
+		console.log("received        " + result.received);
+		console.log("received/s      " + result.receivedPerSec.toFixed(1));
+	}
+
+	console.log("gateway         " + JSON.stringify(result.gateway));
+}
+
+////////////
+// Tunnel //
+////////////
+
+function runTunnel(child, port) {
+	var tunnel = new knx.Tunnel("127.0.0.1", port, {native: options.native, worker: options.worker});
+
+	var pending = [];
+	var samples = [];
+	var acked = 0;
+	var confirmed = 0;
+	var next = 0;
+	var started = 0;
+	var running = false;
+
+	function fill() {
+		while (running && pending.length < options.window) {
+			var value = next++;
+
+			if (!tunnel.write(0, 0x0800 | (value & 255), knx.packUnsigned16(value & 0xFFFF)))
+				break;
+
+			pending.push(now());
+		}
+	}
+
+	tunnel.on("ack", function () {
+		var sent = pending.shift();
+		if (sent == null) return;
+
+		samples.push(now() - sent);
+		acked++;
+
+		fill();
+	});
+
+	tunnel.on("confirmation", function () {
+		confirmed++;
+	});
+
+	tunnel.on("error", function (err) {
+		console.error(err.message);
+		process.exit(1);
+	});
+
+	tunnel.once("connected", function () {
+		running = true;
+		started = now();
+		fill();
+
+		setTimeout(function () {
+			running = false;
+
+			var seconds = (now() - started) / 1e6;
+
+			gatewayStats(child, function (stats) {
+				report({
+					mode:          "tunnel",
+					transport:     options.worker ? "worker" : options.native ? "native" : "js",
+					window:        options.window,
+					seconds:       seconds,
+					frames:        acked,
+					framesPerSec:  acked / seconds,
+					confirmations: confirmed,
+					rtt:           summarize(samples),
+					gateway:       stats
+				});
+
+				tunnel.disconnect();
+				tunnel.dispose();
+				child.disconnect();
+			});
+		}, options.duration);
+	});
+
+	tunnel.connect();
+}
+
+////////////
+// Router //
+////////////
+
+function runRouter(child, port) {
+	var router = new knx.Router("224.0.23.12", port, {loopback: true, native: options.native});
+
+	var sent = 0;
+	var received = 0;
+	var started = now();
+	var running = true;
+
+	// Our own writes come back through the loop as well
+	router.on("indication", function (src) {
+		if (src == Gateway.RoutingSource) received++;
+	});
+
+	function pump() {
+		if (!running) return;
+
+		var due = options.rate > 0 ? Math.floor((now() - started) * options.rate / 1e6) : sent + 64;
+
+		for (; sent < due; sent++)
+			router.write(0x1101, 0x0800 | (sent & 255), knx.packUnsigned16(sent & 0xFFFF));
+
+		if (options.rate > 0)
+			setTimeout(pump, 5);
+		else
+			setImmediate(pump);
+	}
+
+	// Give the socket a moment to join the group
+	setTimeout(function () {
+		started = now();
+		pump();
+
+		setTimeout(function () {
+			running = false;
+
+			var seconds = (now() - started) / 1e6;
+
+			gatewayStats(child, function (stats) {
+				report({
+					mode:           "router",
+					transport:      options.native ? "native" : "js",
+					seconds:        seconds,
+					frames:         sent,
+					framesPerSec:   sent / seconds,
+					received:       received,
+					receivedPerSec: received / seconds,
+					gateway:        stats
+				});
+
+				router.dispose();
+				child.disconnect();
+			});
+		}, options.duration);
+	}, 100);
+}
+
+startGateway(function (child, port) {
+	if (options.mode == "router")
+		runRouter(child, port);
+	else
+		runTunnel(child, port);
+});
@@ -0,0 +1,232 @@
+// Throughput of the libknxproto codecs without V8 in the way. Prints a JSON document in the same
+// shape as 'bench/run.js --json'.
+//
+//   knxproto_bench [--time=<ms>]
+
+extern "C" {
+	#include <knxproto/router.h>
+	#include <knxproto/proto/data.h>
+}
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+using BenchClock = std::chrono::steady_clock;
+
+struct BenchResult {
+	std::string name;
+	uint64_t ops;
+	uint64_t frames;
+	double seconds;
+};
+
+// Keeps the optimizer from discarding results
+static volatile uint64_t bench_sink = 0;
+
+// Runs 'body' in batches of 'batch' until 'time_ms' have passed. 'body' yields the number of frames
+// it produced.
+static
+BenchResult bench_run(const char* name, double time_ms, size_t batch, const std::function<uint64_t(size_t)>& body) {
+	// Warm-up
+	auto warm_until = BenchClock::now() + std::chrono::duration<double, std::milli>(time_ms / 10);
+	while (BenchClock::now() < warm_until)
+		body(batch);
+
+	BenchResult result {name, 0, 0, 0};
+
+	auto start = BenchClock::now();
+	auto limit = std::chrono::duration<double, std::milli>(time_ms);
+
+	do {
+		result.frames += body(batch);
+		result.ops += batch;
+	} while (BenchClock::now() - start < limit);
+
+	result.seconds = std::chrono::duration<double>(BenchClock::now() - start).count();
+	return result;
+}
+
+// Router whose output is captured instead of being put on the wire
+struct BenchRouter {
+	knx_router router;
+
+	uint8_t datagram[512];
+	size_t datagram_length;
+
+	uint64_t received;
+
+	static
+	void cb_send(const knx_router* router, BenchRouter* bench, const uint8_t* message, size_t message_size) {
+		if (message_size > sizeof(bench->datagram)) return;
+
+		std::memcpy(bench->datagram, message, message_size);
+		bench->datagram_length = message_size;
+	}
+
+	static
+	void cb_recv(const knx_router* router, BenchRouter* bench, const knx_cemi* frame) {
+		bench->received++;
+		bench_sink += frame->payload.ldata.destination;
+	}
+
+	BenchRouter(): router {}, datagram_length(0), received(0) {
+		knx_router_set_send_handler(&router, (knx_router_send_cb) &BenchRouter::cb_send, this);
+		knx_router_set_recv_handler(&router, (knx_router_recv_cb) &BenchRouter::cb_recv, this);
+	}
+};
+
+static
+knx_cemi bench_frame(uint16_t destination, const uint8_t* payload, size_t length) {
+	knx_cemi frame {};
+
+	frame.service = KNX_CEMI_LDATA_IND;
+	frame.payload.ldata.control1.priority = KNX_LDATA_PRIO_LOW;
+	frame.payload.ldata.control2.address_type = KNX_LDATA_ADDR_GROUP;
+	frame.payload.ldata.control2.hops = 6;
+	frame.payload.ldata.source = 0x1101;
+	frame.payload.ldata.destination = destination;
+	frame.payload.ldata.tpdu.tpci = KNX_TPCI_UNNUMBERED_DATA;
+	frame.payload.ldata.tpdu.info.data.apci = KNX_APCI_GROUPVALUEWRITE;
+	frame.payload.ldata.tpdu.info.data.payload = payload;
+	frame.payload.ldata.tpdu.info.data.length = length;
+
+	return frame;
+}
+
+// Encodes and decodes a single value of 'type' per operation
+template <typename T>
+static
+void bench_dpt(std::vector<BenchResult>& results, double time_ms, const char* name, knx_dpt type, T value) {
+	uint8_t apdu[16] = {0};
+	size_t length = knx_dpt_size(type);
+
+	results.push_back(bench_run((std::string("native.dpt.to.") + name).c_str(), time_ms, 1000, [&](size_t n) {
+		for (size_t i = 0; i < n; i++) {
+			knx_dpt_to_apdu(apdu, type, &value);
+			bench_sink += apdu[length - 1];
+		}
+
+		return uint64_t(0);
+	}));
+
+	knx_dpt_to_apdu(apdu, type, &value);
+
+	results.push_back(bench_run((std::string("native.dpt.from.") + name).c_str(), time_ms, 1000, [&](size_t n) {
+		T decoded;
+
+		for (size_t i = 0; i < n; i++) {
+			knx_dpt_from_apdu(apdu, length, type, &decoded);
+			bench_sink += ((const uint8_t*) &decoded)[0];
+		}
+
+		return uint64_t(0);
+	}));
+}
+
+int main(int argc, char** argv) {
+	double time_ms = 1000;
+
+	for (int i = 1; i < argc; i++) {
+		if (std::strncmp(argv[i], "--time=", 7) == 0) {
+			time_ms = std::atof(argv[i] + 7);
+		} else {
+			std::fprintf(stderr, "Unknown argument %s\n", argv[i]);
+			return 1;
+		}
+	}
+
+	std::vector<BenchResult> results;
+
+	static const uint8_t payloads[4][14] = {
+		{0x01},
+		{0x0C, 0x1A},
+		{0x41, 0x20, 0x00, 0x00},
+		{'K', 'N', 'X', ' ', 'b', 'e', 'n', 'c', 'h', 'm', 'a', 'r', 'k'}
+	};
+
+	static const size_t payload_lengths[4] = {1, 2, 4, 13};
+
+	// Routing indications to 256 group addresses, generated by the router itself
+	std::vector<std::vector<uint8_t>> datagrams;
+
+	{
+		BenchRouter encoder;
+
+		for (uint16_t i = 0; i < 256; i++) {
+			knx_cemi frame = bench_frame(0x0800 | i, payloads[i & 3], payload_lengths[i & 3]);
+			knx_router_send(&encoder.router, &frame);
+
+			datagrams.emplace_back(encoder.datagram, encoder.datagram + encoder.datagram_length);
+		}
+	}
+
+	BenchRouter router;
+	size_t next = 0;
+
+	results.push_back(bench_run("native.router.process", time_ms, 1000, [&](size_t n) {
+		uint64_t before = router.received;
+
+		for (size_t i = 0; i < n; i++) {
+			const std::vector<uint8_t>& datagram = datagrams[(next++) & 255];
+			knx_router_process(&router.router, datagram.data(), datagram.size());
+		}
+
+		return router.received - before;
+	}));
+
+	std::vector<knx_cemi> frames;
+	for (uint16_t i = 0; i < 256; i++)
+		frames.push_back(bench_frame(0x0800 | i, payloads[i & 3], payload_lengths[i & 3]));
+
+	results.push_back(bench_run("native.router.send", time_ms, 1000, [&](size_t n) {
+		for (size_t i = 0; i < n; i++) {
+			knx_router_send(&router.router, &frames[(next++) & 255]);
+			bench_sink += router.datagram_length;
+		}
+
+		return uint64_t(n);
+	}));
+
+	bench_dpt<knx_unsigned8>(results, time_ms, "unsigned8", KNX_DPT_UNSIGNED8, 200);
+	bench_dpt<knx_unsigned16>(results, time_ms, "unsigned16", KNX_DPT_UNSIGNED16, 50000);
+	bench_dpt<knx_unsigned32>(results, time_ms, "unsigned32", KNX_DPT_UNSIGNED32, 4000000000u);
+	bench_dpt<knx_signed8>(results, time_ms, "signed8", KNX_DPT_SIGNED8, -100);
+	bench_dpt<knx_signed16>(results, time_ms, "signed16", KNX_DPT_SIGNED16, -30000);
+	bench_dpt<knx_signed32>(results, time_ms, "signed32", KNX_DPT_SIGNED32, -2000000000);
+	bench_dpt<knx_float16>(results, time_ms, "float16", KNX_DPT_FLOAT16, 21.5f);
+	bench_dpt<knx_float32>(results, time_ms, "float32", KNX_DPT_FLOAT32, 1013.25f);
+	bench_dpt<knx_bool>(results, time_ms, "bool", KNX_DPT_BOOL, true);
+	bench_dpt<knx_char>(results, time_ms, "char", KNX_DPT_CHAR, 'K');
+	bench_dpt<knx_cvalue>(results, time_ms, "cvalue", KNX_DPT_CVALUE, knx_cvalue {true, false});
+	bench_dpt<knx_cstep>(results, time_ms, "cstep", KNX_DPT_CSTEP, knx_cstep {false, 3});
+	bench_dpt<knx_timeofday>(results, time_ms, "timeofday", KNX_DPT_TIMEOFDAY, knx_timeofday {knx_dayofweek(2), 13, 37, 5});
+	bench_dpt<knx_date>(results, time_ms, "date", KNX_DPT_DATE, knx_date {17, 10, 26});
+
+	std::printf("{\n\t\"cases\": [\n");
+
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchResult& r = results[i];
+
+		std::printf(
+			"\t\t{\"name\": \"%s\", \"ops\": %llu, \"seconds\": %.6f, \"opsPerSec\": %.1f, "
+			"\"nsPerOp\": %.3f, \"framesPerSec\": %.1f, \"allocationsPerOp\": 0, \"gcMs\": null, "
+			"\"gcCount\": null}%s\n",
+			r.name.c_str(),
+			(unsigned long long) r.ops,
+			r.seconds,
+			r.ops / r.seconds,
+			r.seconds * 1e9 / r.ops,
+			r.frames / r.seconds,
+			i + 1 < results.size() ? "," : ""
+		);
+	}
+
+	std::printf("\t]\n}\n");
+
+	return 0;
+}
@@ -0,0 +1,478 @@
+// Throughput benchmark for the native codec and protocol paths
+//
+//   node bench/run.js [--time=<ms>] [--filter=<regex>] [--json] [--native]
+//
+// Every case runs for roughly '--time' milliseconds after a short warm-up. '--json' prints a single
+// machine-readable document instead of the table, '--native' adds the results of the
+// 'knxproto_bench' executable.
+
+var child_process = require("child_process");
+var path          = require("path");
+var perf_hooks    = require("perf_hooks");
+var proto         = require("bindings")("knxproto.node");
+var datagrams     = require("./datagrams.js");
+
+var options = {time: 1000, filter: null, json: false, native: false};
+
+process.argv.slice(2).forEach(function (arg) {
+	var match = /^--([a-z]+)(?:=(.*))?$/.exec(arg);
+	if (!match) throw new Error("Unknown argument " + arg);
+
+	switch (match[1]) {
+		case "time":   options.time = Number(match[2]); break;
+		case "filter": options.filter = new RegExp(match[2]); break;
+		case "json":   options.json = true; break;
+		case "native": options.native = true; break;
+		default:       throw new Error("Unknown option " + match[1]);
+	}
+});
+
+/////////////////
+// Measurement //
+/////////////////
+
+var gcTime = 0;
+var gcCount = 0;
+
+new perf_hooks.PerformanceObserver(function (list) {
+	list.getEntries().forEach(function (entry) {
+		gcTime += entry.duration;
+		gcCount++;
+	});
+}).observe({entryTypes: ["gc"]});
+
+// Buffers handed out by the native pool or the heap behind it
+function nativeAllocations() {
+	var stats = proto.getBufferPoolStats();
+
+	return stats.classes.reduce(function (sum, cls) {
+		return sum + cls.allocations;
+	}, stats.heapAllocations);
+}
+
+// Observed GC entries arrive asynchronously, give them a chance to land
+function settle(done) {
+	setTimeout(done, 10);
+}
+
+// 'body(n)' performs 'n' operations and yields the number of frames they produced, if any
+function measure(bench, done) {
+	var state = bench.setup ? bench.setup() : null;
+	var batch = bench.batch || 1000;
+
+	// Warm-up, lets the JIT settle on the hot path
+	for (var warm = Date.now(); Date.now() - warm < options.time / 10;)
+		bench.body(state, batch);
+
+	settle(function () {
+		var gcTimeBefore = gcTime;
+		var gcCountBefore = gcCount;
+		var allocsBefore = nativeAllocations();
+
+		var ops = 0;
+		var frames = 0;
+		var limit = options.time * 1e6;
+		var start = process.hrtime();
+		var elapsed = 0;
+
+		do {
+			frames += bench.body(state, batch) || 0;
+			ops += batch;
+
+			var diff = process.hrtime(start);
+			elapsed = diff[0] * 1e9 + diff[1];
+		} while (elapsed < limit);
+
+		var allocs = nativeAllocations() - allocsBefore;
+
+		settle(function () {
+			if (bench.teardown) bench.teardown(state);
+
+			done({
+				name:             bench.name,
+				ops:              ops,
+				seconds:          elapsed / 1e9,
+				opsPerSec:        ops / (elapsed / 1e9),
+				nsPerOp:          elapsed / ops,
+				framesPerSec:     frames / (elapsed / 1e9),
+				allocationsPerOp: allocs / ops,
+				gcMs:             gcTime - gcTimeBefore,
+				gcCount:          gcCount - gcCountBefore
+			});
+		});
+	});
+}
+
+///////////////
+// Workloads //
+///////////////
+
+var payloads = [
+	Buffer.from([1]),
+	Buffer.from([0x0C, 0x1A]),
+	Buffer.from([0x41, 0x20, 0x00, 0x00]),
+	Buffer.from("KNX benchmark!")
+];
+
+// Routing indications to 256 group addresses with a mix of payload sizes
+var routingMessages = [];
+
+for (var i = 0; i < 256; i++)
+	routingMessages.push(datagrams.routingIndication(0x1101, 0x0800 | i, payloads[i % payloads.length]));
+
+var sendFrames = payloads.map(function (payload, i) {
+	return {
+		service: proto.LDataRequest,
+		payload: {
+			source: 0x1101,
+			destination: 0x0800 | i,
+			tpdu: {
+				tpci: proto.UnnumberedData,
+				apci: proto.GroupValueWrite,
+				payload: payload
+			}
+		}
+	};
+});
+
+function createRouter(counter, zeroCopy) {
+	var ext = proto.createRouter(function () {}, function () { counter.frames++; });
+	if (zeroCopy) proto.setRouterZeroCopy(ext, true);
+
+	return ext;
+}
+
+function routerProcess(zeroCopy) {
+	return {
+		name: "router.process" + (zeroCopy ? ".zeroCopy" : ""),
+
+		setup: function () {
+			var state = {frames: 0, next: 0};
+			state.ext = createRouter(state, zeroCopy);
+
+			return state;
+		},
+
+		body: function (state, n) {
+			state.frames = 0;
+
+			for (var i = 0; i < n; i++)
+				proto.processRouter(state.ext, routingMessages[(state.next++) & 255]);
+
+			return state.frames;
+		},
+
+		teardown: function (state) {
+			proto.disposeRouter(state.ext);
+		}
+	};
+}
+
+// Tunnel which has been led through the connection handshake with a made-up gateway
+function createConnectedTunnel(state) {
+	state.ext = proto.createTunnel(
+		function () {},
+		function () {},
+		function () { state.frames++; },
+		function () {},
+		function () {}
+	);
+
+	proto.connectTunnel(state.ext);
+	proto.processTunnel(state.ext, datagrams.connectResponse(1, 0, 0x7F000001, 3671, 0x11FF));
+
+	state.messages = [];
+	for (var i = 0; i < 256; i++) {
+		var frame = datagrams.ldata(datagrams.LDataIndication, 0x1101, 0x0800 | i, payloads[i % payloads.length]);
+		state.messages.push(datagrams.tunnelRequest(1, i, frame));
+	}
+
+	return state;
+}
+
+var benches = [
+	routerProcess(false),
+	routerProcess(true),
+
+	{
+		name: "router.processBatch",
+		batch: 64,
+
+		setup: function () {
+			var state = {frames: 0, messages: routingMessages.slice(0, 64)};
+			state.ext = createRouter(state);
+
+			return state;
+		},
+
+		body: function (state, n) {
+			return proto.processRouterBatch(state.ext, state.messages).length;
+		},
+
+		teardown: function (state) {
+			proto.disposeRouter(state.ext);
+		}
+	},
+
+	{
+		name: "router.send",
+
+		setup: function () {
+			var state = {frames: 0, next: 0};
+			state.ext = proto.createRouter(function () { state.frames++; }, function () {});
+
+			return state;
+		},
+
+		body: function (state, n) {
+			state.frames = 0;
+
+			for (var i = 0; i < n; i++)
+				proto.sendRouter(state.ext, sendFrames[(state.next++) & 3]);
+
+			return state.frames;
+		},
+
+		teardown: function (state) {
+			proto.disposeRouter(state.ext);
+		}
+	},
+
+	// Unmarshalling dominates here, as the tunnel only frames what it is given
+	{
+		name: "tunnel.send",
+
+		setup: function () {
+			var state = {frames: 0, next: 0};
+			state.ext = proto.createTunnel(function () {}, function () { state.frames++; }, function () {}, function () {}, function () {});
+
+			proto.connectTunnel(state.ext);
+			proto.processTunnel(state.ext, datagrams.connectResponse(1, 0, 0x7F000001, 3671, 0x11FF));
+
+			// Only count tunnel requests
+			state.frames = 0;
+
+			return state;
+		},
+
+		body: function (state, n) {
+			state.frames = 0;
+
+			for (var i = 0; i < n; i++)
+				proto.sendTunnel(state.ext, sendFrames[(state.next++) & 3]);
+
+			return state.frames;
+		},
+
+		teardown: function (state) {
+			proto.disposeTunnel(state.ext);
+		}
+	},
+
+	{
+		name: "frame.validate",
+
+		body: function (state, n) {
+			for (var i = 0; i < n; i++)
+				proto.frameError(sendFrames[i & 3]);
+		}
+	},
+
+	{
+		name: "tunnel.process",
+
+		// A sequence of 256 requests keeps the numbering in step with what the tunnel expects
+		batch: 256,
+
+		setup: function () {
+			return createConnectedTunnel({frames: 0});
+		},
+
+		body: function (state, n) {
+			state.frames = 0;
+
+			for (var i = 0; i < n; i++)
+				proto.processTunnel(state.ext, state.messages[i & 255]);
+
+			return state.frames;
+		},
+
+		teardown: function (state) {
+			proto.disposeTunnel(state.ext);
+		}
+	}
+];
+
+// Every data type, in each of its pack/unpack flavours
+var dataTypes = [
+	["Unsigned8",  200],
+	["Unsigned16", 50000],
+	["Unsigned32", 4000000000],
+	["Signed8",    -100],
+	["Signed16",   -30000],
+	["Signed32",   -2000000000],
+	["Float16",    21.5],
+	["Float32",    1013.25],
+	["Bool",       true],
+	["Char",       "K"],
+	["CValue",     {control: true, value: false}],
+	["CStep",      {control: false, step: 3}],
+	["TimeOfDay",  {day: 2, hour: 13, minute: 37, second: 5}],
+	["Date",       {day: 17, month: 10, year: 26}]
+];
+
+dataTypes.forEach(function (entry) {
+	var name = entry[0];
+	var value = entry[1];
+
+	var pack = proto["pack" + name];
+	var packInto = proto["pack" + name + "Into"];
+	var unpack = proto["unpack" + name];
+
+	var encoded = pack(value);
+	var target = Buffer.alloc(16);
+
+	benches.push({
+		name: "data.pack" + name,
+		body: function (state, n) {
+			for (var i = 0; i < n; i++) pack(value);
+		}
+	});
+
+	benches.push({
+		name: "data.pack" + name + "Into",
+		body: function (state, n) {
+			for (var i = 0; i < n; i++) packInto(target, 0, value);
+		}
+	});
+
+	benches.push({
+		name: "data.unpack" + name,
+		body: function (state, n) {
+			for (var i = 0; i < n; i++) unpack(encoded);
+		}
+	});
+});
+
+// Identifier based codecs, covering both those backed by libknxproto and the built-in ones
+[["5.001", 50], ["9.001", 21.5], ["14.068", 1013.25]].forEach(function (entry) {
+	var label = entry[0];
+	var value = entry[1];
+
+	var parts = label.split(".");
+	var id = ((parts[0] << 16) | parts[1]) >>> 0;
+	var encoded = proto.pack(id, value);
+
+	benches.push({
+		name: "dpt.pack." + label,
+		body: function (state, n) {
+			for (var i = 0; i < n; i++) proto.pack(id, value);
+		}
+	});
+
+	benches.push({
+		name: "dpt.unpack." + label,
+		body: function (state, n) {
+			for (var i = 0; i < n; i++) proto.unpack(id, encoded);
+		}
+	});
+});
+
+// Bulk codecs over 64 values
+["Float16", "Float32", "Unsigned16"].forEach(function (name) {
+	var values = [];
+	for (var i = 0; i < 64; i++) values.push(name == "Unsigned16" ? i * 1000 : i * 1.5);
+
+	var packArray = proto["pack" + name + "Array"];
+	var unpackArray = proto["unpack" + name + "Array"];
+	var encoded = packArray(values);
+	var stride = encoded.length / 64;
+
+	benches.push({
+		name: "bulk.pack" + name + "Array",
+		batch: 100,
+		body: function (state, n) {
+			for (var i = 0; i < n; i++) packArray(values);
+		}
+	});
+
+	benches.push({
+		name: "bulk.unpack" + name + "Array",
+		batch: 100,
+		body: function (state, n) {
+			for (var i = 0; i < n; i++) unpackArray(encoded, stride, 64);
+		}
+	});
+});
+
+///////////////
+// Reporting //
+///////////////
+
+function runNative() {
+	var binary = path.join(__dirname, "..", "build", "Release", "knxproto_bench");
+	var result = child_process.spawnSync(binary, ["--time=" + options.time], {encoding: "utf8"});
+
+	if (result.error || result.status != 0)
+		throw new Error("Failed to run " + binary);
+
+	return JSON.parse(result.stdout).cases;
+}
+
+function pad(value, width) {
+	value = String(value);
+	return value.length < width ? new Array(width - value.length + 1).join(" ") + value : value;
+}
+
+function report(results) {
+	if (options.json) {
+		process.stdout.write(JSON.stringify({
+			node:      process.version,
+			arch:      process.arch,
+			timestamp: new Date().toISOString(),
+			time:      options.time,
+			cases:     results
+		}, null, "\t") + "\n");
+
+		return;
+	}
+
+	console.log(
+		"case".padEnd(32) + pad("ops/s", 14) + pad("ns/op", 10) +
+		pad("frames/s", 14) + pad("allocs/op", 11) + pad("gc ms", 9)
+	);
+
+	results.forEach(function (r) {
+		console.log(
+			r.name.padEnd(32) +
+			pad(Math.round(r.opsPerSec), 14) +
+			pad(r.nsPerOp.toFixed(1), 10) +
+			pad(r.framesPerSec ? Math.round(r.framesPerSec) : "-", 14) +
+			pad(r.allocationsPerOp != null ? r.allocationsPerOp.toFixed(2) : "-", 11) +
+			pad(r.gcMs != null ? r.gcMs.toFixed(1) : "-", 9)
+		);
+	});
+}
+
+var selected = benches.filter(function (bench) {
+	return !options.filter || options.filter.test(bench.name);
+});
+
+var results = [];
+
+(function next(index) {
+	if (index == selected.length) {
+		if (options.native)
+			results = results.concat(runNative().filter(function (r) {
+				return !options.filter || options.filter.test(r.name);
+			}));
+
+		report(results);
+		return;
+	}
+
+	measure(selected[index], function (result) {
+		results.push(result);
+		next(index + 1);
+	});
+})(0);
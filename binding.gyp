@@ -4,7 +4,20 @@
 			"target_name": "knxproto",
 			"sources": [
 				"lib/knxproto.cpp",
+				"lib/bulk.cpp",
+				"lib/cache.cpp",
+				"lib/capture.cpp",
+				"lib/codec.cpp",
+				"lib/columns.cpp",
 				"lib/data.cpp",
+				"lib/delivery.cpp",
+				"lib/dpt.cpp",
+				"lib/pool.cpp",
+				"lib/queue.cpp",
+				"lib/scheduler.cpp",
+				"lib/stats.cpp",
+				"lib/transport.cpp",
+				"lib/worker.cpp",
 			],
 			"cflags": [
 				"-std=c++14",
@@ -22,6 +35,53 @@
 			"ldflags": [
 				"-lknxproto"
 			]
+		},
+		{
+			"target_name": "knxproto_bench",
+			"type": "executable",
+			"sources": [
+				"bench/native.cpp"
+			],
+			"cflags": [
+				"-std=c++14",
+				"-O2",
+				"-Wall",
+				"-Wextra",
+				"-pedantic",
+				"-fmessage-length=0",
+				"-Wno-unused-parameter",
+				"-Wno-missing-field-initializers"
+			],
+			"libraries": [
+				"-lknxproto"
+			]
+		},
+		{
+			"target_name": "knxproto_test",
+			"type": "executable",
+			"sources": [
+				"test/native.cpp",
+				"lib/capture.cpp",
+				"lib/codec.cpp",
+				"lib/delivery.cpp",
+				"lib/queue.cpp",
+				"lib/scheduler.cpp",
+				"lib/stats.cpp"
+			],
+			"cflags": [
+				"-std=c++14",
+				"-O2",
+				"-Wall",
+				"-Wextra",
+				"-pedantic",
+				"-fmessage-length=0",
+				"-Wno-unused-parameter",
+				"-Wno-unused-result",
+				"-Wno-missing-field-initializers"
+			],
+			"libraries": [
+				"-luv"
+			]
 		}
 	]
 }
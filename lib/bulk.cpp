@@ -0,0 +1,41 @@
+#include "bulk.hpp"
+#include "data.hpp"
+#include "pool.hpp"
+
+using namespace jawra;
+using namespace v8;
+
+#define KNXPROTO_PARSE_ARRAY_DEF(n, s) KNXPROTO_PARSE_ARRAY_DECL(n) { \
+	Isolate* isolate = Isolate::GetCurrent(); \
+	\
+	if (!payload.data || stride < s || (count > 0 && (count - 1) * size_t(stride) + s > payload.length)) \
+		return Null(isolate); \
+	\
+	Local<ArrayBuffer> result = ArrayBuffer::New(isolate, count * sizeof(double)); \
+	knxproto_bulk_decode_##n((const uint8_t*) payload.data, stride, count, (double*) result->GetContents().Data()); \
+	\
+	return Float64Array::New(result, 0, count); \
+}
+
+KNXPROTO_PARSE_ARRAY_DEF(float16,    2)
+KNXPROTO_PARSE_ARRAY_DEF(float32,    4)
+KNXPROTO_PARSE_ARRAY_DEF(unsigned16, 2)
+
+#define KNXPROTO_MAKE_ARRAY_DEF(n, s) KNXPROTO_MAKE_ARRAY_DECL(n) { \
+	if (!values->IsFloat64Array()) \
+		return Null(Isolate::GetCurrent()); \
+	\
+	Local<Float64Array> array = values.As<Float64Array>(); \
+	const double* input = (const double*) \
+		((const uint8_t*) array->Buffer()->GetContents().Data() + array->ByteOffset()); \
+	\
+	size_t length = array->Length() * s; \
+	char* buffer = knxproto_pool_alloc(length); \
+	knxproto_bulk_encode_##n(input, array->Length(), (uint8_t*) buffer); \
+	\
+	return knxproto_make_buffer(buffer, length); \
+}
+
+KNXPROTO_MAKE_ARRAY_DEF(float16,    2)
+KNXPROTO_MAKE_ARRAY_DEF(float32,    4)
+KNXPROTO_MAKE_ARRAY_DEF(unsigned16, 2)
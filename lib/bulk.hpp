@@ -0,0 +1,27 @@
+#ifndef KNXPROTO_LIB_BULK_H_
+#define KNXPROTO_LIB_BULK_H_
+
+#include "codec.hpp"
+
+#include <jawra/values.hpp>
+
+#include <v8.h>
+
+// Unpacking reads 'count' values spaced 'stride' bytes apart and yields a Float64Array, packing
+// turns a Float64Array into one contiguous Buffer. See 'codec.hpp' for the conversions themselves.
+
+#define KNXPROTO_PARSE_ARRAY_DECL(n) \
+	v8::Handle<v8::Value> knxproto_parse_##n##_array(jawra::Buffer payload, uint32_t stride, uint32_t count)
+
+KNXPROTO_PARSE_ARRAY_DECL(float16);
+KNXPROTO_PARSE_ARRAY_DECL(float32);
+KNXPROTO_PARSE_ARRAY_DECL(unsigned16);
+
+#define KNXPROTO_MAKE_ARRAY_DECL(n) \
+	v8::Handle<v8::Value> knxproto_make_##n##_array(v8::Local<v8::Value> values)
+
+KNXPROTO_MAKE_ARRAY_DECL(float16);
+KNXPROTO_MAKE_ARRAY_DECL(float32);
+KNXPROTO_MAKE_ARRAY_DECL(unsigned16);
+
+#endif
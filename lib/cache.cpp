@@ -0,0 +1,101 @@
+#include "cache.hpp"
+#include "data.hpp"
+#include "pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace v8;
+
+static
+double cache_now() {
+	using namespace std::chrono;
+	return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+static
+Local<Object> cache_pack(Isolate* isolate, knx_addr addr, const GroupValue& value) {
+	Local<Object> object = Object::New(isolate);
+
+	char* payload = knxproto_pool_alloc(value.length);
+	std::copy(value.payload, value.payload + value.length, payload);
+
+	object->Set(String::NewFromUtf8(isolate, "destination"), Integer::NewFromUnsigned(isolate, addr));
+	object->Set(String::NewFromUtf8(isolate, "source"),      Integer::NewFromUnsigned(isolate, value.source));
+	object->Set(String::NewFromUtf8(isolate, "apci"),        Integer::NewFromUnsigned(isolate, value.apci));
+	object->Set(String::NewFromUtf8(isolate, "timestamp"),   Number::New(isolate, value.timestamp));
+	object->Set(String::NewFromUtf8(isolate, "payload"),     knxproto_make_buffer(payload, value.length));
+
+	return object;
+}
+
+GroupValueCache::~GroupValueCache() {
+	for (GroupValue* page: pages)
+		delete[] page;
+}
+
+void GroupValueCache::update(const knx_cemi& frame) {
+	const knx_ldata& ldata = frame.payload.ldata;
+
+	if (ldata.control2.address_type != KNX_LDATA_ADDR_GROUP ||
+	    (ldata.tpdu.tpci != KNX_TPCI_UNNUMBERED_DATA && ldata.tpdu.tpci != KNX_TPCI_NUMBERED_DATA))
+		return;
+
+	knx_apci apci = ldata.tpdu.info.data.apci;
+	size_t length = ldata.tpdu.info.data.length;
+
+	if (apci != KNX_APCI_GROUPVALUEWRITE && apci != KNX_APCI_GROUPVALUERESPONSE)
+		return;
+
+	GroupValue*& page = pages[ldata.destination >> 8];
+
+	// Payloads which don't fit are not kept, but the previous value is outdated all the same
+	if (length > sizeof(GroupValue::payload)) {
+		if (page) page[ldata.destination & 255].valid = false;
+		return;
+	}
+
+	if (!page) page = new GroupValue[256] {};
+
+	GroupValue& value = page[ldata.destination & 255];
+
+	std::copy(ldata.tpdu.info.data.payload, ldata.tpdu.info.data.payload + length, value.payload);
+	value.length = length;
+	value.valid = true;
+	value.apci = apci;
+	value.source = ldata.source;
+	value.timestamp = cache_now();
+}
+
+const GroupValue* GroupValueCache::find(knx_addr addr) const {
+	const GroupValue* page = pages[addr >> 8];
+
+	if (!page || !page[addr & 255].valid)
+		return nullptr;
+
+	return &page[addr & 255];
+}
+
+Local<Value> GroupValueCache::lookup(Isolate* isolate, knx_addr addr) const {
+	const GroupValue* value = find(addr);
+
+	if (!value)
+		return Null(isolate);
+
+	return cache_pack(isolate, addr, *value);
+}
+
+Local<Array> GroupValueCache::snapshot(Isolate* isolate) const {
+	Local<Array> values = Array::New(isolate);
+	uint32_t length = 0;
+
+	for (size_t p = 0; p < 256; p++) {
+		if (!pages[p]) continue;
+
+		for (size_t i = 0; i < 256; i++)
+			if (pages[p][i].valid)
+				values->Set(length++, cache_pack(isolate, knx_addr(p << 8 | i), pages[p][i]));
+	}
+
+	return values;
+}
@@ -0,0 +1,42 @@
+#ifndef KNXPROTO_LIB_CACHE_H_
+#define KNXPROTO_LIB_CACHE_H_
+
+extern "C" {
+	#include <knxproto/proto/cemi.h>
+}
+
+#include <v8.h>
+
+#include <cstddef>
+#include <cstdint>
+
+struct GroupValue {
+	uint8_t payload[16];
+	uint8_t length;
+	bool valid;
+	uint16_t apci;
+	knx_addr source;
+
+	// Milliseconds since the epoch
+	double timestamp;
+};
+
+// Last value seen on each group address. Entries are stored in pages of 256 addresses, which are
+// allocated when the first value for one of their addresses arrives.
+struct GroupValueCache {
+	GroupValue* pages[256];
+
+	~GroupValueCache();
+
+	// Record the payload of GroupValueWrite and GroupValueResponse frames. A payload longer than 16
+	// bytes clears the entry instead.
+	void update(const knx_cemi& frame);
+
+	const GroupValue* find(knx_addr addr) const;
+
+	v8::Local<v8::Value> lookup(v8::Isolate* isolate, knx_addr addr) const;
+
+	v8::Local<v8::Array> snapshot(v8::Isolate* isolate) const;
+};
+
+#endif
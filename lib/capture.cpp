@@ -0,0 +1,396 @@
+#include "capture.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char capture_magic[8] = {'K', 'N', 'X', 'C', 'A', 'P', 0, 0};
+static const uint32_t capture_version = 1;
+static const char capture_suffix[] = ".knxcap";
+
+static inline
+size_t capture_padded(size_t length) {
+	return (length + 7) & ~size_t(7);
+}
+
+std::string capture_segment_path(const std::string& prefix, uint32_t index) {
+	char name[32];
+	std::snprintf(name, sizeof(name), ".%06u%s", index, capture_suffix);
+
+	return prefix + name;
+}
+
+std::vector<uint32_t> capture_segments(const std::string& prefix) {
+	std::vector<uint32_t> segments;
+
+	size_t slash = prefix.rfind('/');
+	std::string directory = slash == std::string::npos ? "." : prefix.substr(0, slash + 1);
+	std::string base = (slash == std::string::npos ? prefix : prefix.substr(slash + 1)) + ".";
+
+	DIR* dir = opendir(directory.c_str());
+	if (!dir) return segments;
+
+	size_t suffix_length = sizeof(capture_suffix) - 1;
+
+	while (dirent* ent = readdir(dir)) {
+		std::string name = ent->d_name;
+
+		if (name.size() <= base.size() + suffix_length ||
+		    name.compare(0, base.size(), base) != 0 ||
+		    name.compare(name.size() - suffix_length, suffix_length, capture_suffix) != 0)
+			continue;
+
+		std::string digits = name.substr(base.size(), name.size() - base.size() - suffix_length);
+		if (digits.find_first_not_of("0123456789") != std::string::npos)
+			continue;
+
+		segments.push_back((uint32_t) std::strtoul(digits.c_str(), nullptr, 10));
+	}
+
+	closedir(dir);
+	std::sort(segments.begin(), segments.end());
+
+	return segments;
+}
+
+////////////
+// Writer //
+////////////
+
+CaptureLog* CaptureLog::open(const std::string& prefix, size_t segment_size, size_t max_segments) {
+	size_t minimum = sizeof(CaptureSegmentHeader) + 2 * sizeof(CaptureRecordHeader) + capture_padded(UINT16_MAX);
+	segment_size = capture_padded(std::max(segment_size, minimum));
+
+	// Earlier captures are kept, whatever they were recorded for
+	if (!capture_segments(prefix).empty())
+		return nullptr;
+
+	CaptureLog* log = new CaptureLog;
+
+	log->prefix = prefix;
+	log->segment_size = segment_size;
+	log->max_segments = max_segments;
+	log->first_segment = 0;
+	log->segment = 0;
+	log->fd = -1;
+	log->map = nullptr;
+	log->offset = 0;
+	log->records = 0;
+	log->bytes = 0;
+	log->dropped = 0;
+
+	if (!log->open_segment()) {
+		delete log;
+		return nullptr;
+	}
+
+	return log;
+}
+
+bool CaptureLog::open_segment() {
+	std::string path = capture_segment_path(prefix, segment);
+
+	fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd < 0) return false;
+
+	// The file is zero-filled, which leaves a terminating record after the last one written
+	if (ftruncate(fd, segment_size) != 0) {
+		::close(fd);
+		fd = -1;
+
+		return false;
+	}
+
+	void* mapping = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	if (mapping == MAP_FAILED) {
+		::close(fd);
+		fd = -1;
+
+		return false;
+	}
+
+	map = (uint8_t*) mapping;
+
+	CaptureSegmentHeader header;
+	std::memcpy(header.magic, capture_magic, sizeof(header.magic));
+	header.version = capture_version;
+	header.index = segment;
+
+	std::memcpy(map, &header, sizeof(header));
+	offset = sizeof(header);
+
+	return true;
+}
+
+void CaptureLog::close_segment() {
+	if (!map) return;
+
+	munmap(map, segment_size);
+	map = nullptr;
+
+	// Leave the terminating record in place
+	ftruncate(fd, std::min(segment_size, offset + sizeof(CaptureRecordHeader)));
+
+	::close(fd);
+	fd = -1;
+}
+
+bool CaptureLog::append(uint64_t timestamp, CaptureDirection direction, const uint8_t* data, size_t length) {
+	size_t size = sizeof(CaptureRecordHeader) + capture_padded(length);
+
+	if (length > UINT16_MAX || timestamp == 0 || !map) {
+		dropped++;
+		return false;
+	}
+
+	if (offset + size + sizeof(CaptureRecordHeader) > segment_size) {
+		close_segment();
+		segment++;
+
+		if (!open_segment()) {
+			dropped++;
+			return false;
+		}
+
+		if (max_segments > 0) {
+			for (; segment - first_segment >= max_segments; first_segment++)
+				unlink(capture_segment_path(prefix, first_segment).c_str());
+		}
+	}
+
+	CaptureRecordHeader header {timestamp, (uint16_t) length, direction, {0}};
+
+	std::memcpy(map + offset, &header, sizeof(header));
+	std::memcpy(map + offset + sizeof(header), data, length);
+	offset += size;
+
+	records++;
+	bytes += length;
+
+	return true;
+}
+
+void CaptureLog::close() {
+	close_segment();
+	delete this;
+}
+
+////////////
+// Reader //
+////////////
+
+CaptureReader* CaptureReader::open(const std::string& prefix) {
+	std::vector<uint32_t> segments = capture_segments(prefix);
+	if (segments.empty()) return nullptr;
+
+	CaptureReader* reader = new CaptureReader;
+
+	reader->prefix = prefix;
+	reader->segments = segments;
+	reader->next_segment = 0;
+	reader->fd = -1;
+	reader->map = nullptr;
+	reader->size = 0;
+	reader->offset = 0;
+
+	return reader;
+}
+
+bool CaptureReader::open_segment() {
+	std::string path = capture_segment_path(prefix, segments[next_segment++]);
+
+	fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) return false;
+
+	struct stat info;
+
+	if (fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(CaptureSegmentHeader)) {
+		close_segment();
+		return false;
+	}
+
+	void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	if (mapping == MAP_FAILED) {
+		close_segment();
+		return false;
+	}
+
+	map = (const uint8_t*) mapping;
+	size = info.st_size;
+
+	CaptureSegmentHeader header;
+	std::memcpy(&header, map, sizeof(header));
+
+	if (std::memcmp(header.magic, capture_magic, sizeof(capture_magic)) != 0 || header.version != capture_version) {
+		close_segment();
+		return false;
+	}
+
+	offset = sizeof(header);
+	return true;
+}
+
+void CaptureReader::close_segment() {
+	if (map) munmap((void*) map, size);
+	if (fd >= 0) ::close(fd);
+
+	map = nullptr;
+	fd = -1;
+	size = 0;
+	offset = 0;
+}
+
+bool CaptureReader::next(CaptureEntry& entry) {
+	for (;;) {
+		if (map && offset + sizeof(CaptureRecordHeader) <= size) {
+			CaptureRecordHeader header;
+			std::memcpy(&header, map + offset, sizeof(header));
+
+			size_t end = offset + sizeof(header) + capture_padded(header.length);
+
+			if (header.timestamp != 0 && end <= size) {
+				entry.timestamp = header.timestamp;
+				entry.direction = (CaptureDirection) header.direction;
+				entry.data = map + offset + sizeof(header);
+				entry.length = header.length;
+
+				offset = end;
+				return true;
+			}
+		}
+
+		// Segments which can not be read are skipped
+		do {
+			close_segment();
+			if (next_segment >= segments.size()) return false;
+		} while (!open_segment());
+	}
+}
+
+CaptureReader::~CaptureReader() {
+	close_segment();
+}
+
+////////////
+// Replay //
+////////////
+
+static
+void capture_replay_timeout(uv_timer_t* timer) {
+	CaptureReplay* replay = (CaptureReplay*) timer->data;
+	replay->handlers.timeout(replay->data);
+}
+
+CaptureReplay* CaptureReplay::create(
+	const ReplayHandlers& handlers,
+	void*                 data,
+	CaptureReader*        reader,
+	double                speed,
+	uv_loop_t*            loop
+) {
+	CaptureReplay* replay = new CaptureReplay;
+
+	replay->handlers = handlers;
+	replay->data = data;
+	replay->reader = reader;
+	replay->speed = speed;
+	replay->pending = false;
+	replay->first_timestamp = 0;
+	replay->started_at = 0;
+	replay->fed = 0;
+	replay->pumping = false;
+	replay->stopped = false;
+
+	uv_timer_init(loop, &replay->timer);
+	replay->timer.data = replay;
+
+	uv_timer_start(&replay->timer, capture_replay_timeout, 0, 0);
+
+	return replay;
+}
+
+void CaptureReplay::pump() {
+	if (stopped) return;
+
+	pumping = true;
+	feed_batch();
+	pumping = false;
+
+	// Stopped while feeding, the instance could not be closed then
+	if (stopped) close();
+}
+
+void CaptureReplay::feed_batch() {
+	for (size_t count = 0; count < batch; count++) {
+		if (!pending) {
+			// Outbound records are what we sent ourselves, they are of no use to the receiving end
+			do {
+				if (!reader->next(entry)) {
+					stop();
+					return;
+				}
+			} while (entry.direction != CAPTURE_INBOUND);
+
+			pending = true;
+		}
+
+		if (speed > 0) {
+			uint64_t now = uv_hrtime();
+
+			if (started_at == 0) {
+				first_timestamp = entry.timestamp;
+				started_at = now;
+			}
+
+			double due = (entry.timestamp - first_timestamp) / speed;
+			double elapsed = now - started_at;
+
+			if (due > elapsed) {
+				uint64_t wait = (uint64_t) std::ceil((due - elapsed) / 1e6);
+				uv_timer_start(&timer, capture_replay_timeout, wait, 0);
+
+				return;
+			}
+		}
+
+		pending = false;
+		fed++;
+
+		handlers.feed(data, entry.data, entry.length);
+
+		// The handler may have stopped the replay
+		if (stopped) return;
+	}
+
+	// Let the event loop breathe before the next batch
+	uv_timer_start(&timer, capture_replay_timeout, 0, 0);
+}
+
+void CaptureReplay::stop() {
+	if (stopped) return;
+
+	stopped = true;
+	handlers.done(data, fed);
+
+	if (!pumping) close();
+}
+
+void CaptureReplay::close() {
+	delete reader;
+	reader = nullptr;
+
+	uv_timer_stop(&timer);
+	uv_close((uv_handle_t*) &timer, [](uv_handle_t* handle) {
+		delete (CaptureReplay*) handle->data;
+	});
+}
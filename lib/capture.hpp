@@ -0,0 +1,169 @@
+#ifndef KNXPROTO_LIB_CAPTURE_H_
+#define KNXPROTO_LIB_CAPTURE_H_
+
+#include <uv.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A capture log is a series of segments named '<prefix>.<index>.knxcap'. Every segment starts with
+// a 'CaptureSegmentHeader', followed by records which consist of a 'CaptureRecordHeader' and the
+// raw datagram, padded to 8 bytes. A record with a zero timestamp marks the end of a segment.
+
+enum CaptureDirection: uint8_t {
+	CAPTURE_INBOUND  = 0,
+	CAPTURE_OUTBOUND = 1
+};
+
+struct CaptureSegmentHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t index;
+};
+
+struct CaptureRecordHeader {
+	// uv_hrtime() at the time of capture, nanoseconds
+	uint64_t timestamp;
+	uint16_t length;
+	uint8_t direction;
+	uint8_t reserved[5];
+};
+
+struct CaptureEntry {
+	uint64_t timestamp;
+	CaptureDirection direction;
+	const uint8_t* data;
+	size_t length;
+};
+
+// Indices of the segments belonging to 'prefix' in ascending order
+std::vector<uint32_t> capture_segments(const std::string& prefix);
+
+std::string capture_segment_path(const std::string& prefix, uint32_t index);
+
+// Appends datagrams to memory-mapped segments of 'segment_size' bytes. A full segment is truncated
+// to the bytes in use and the next one is started; beyond 'max_segments' (zero means no limit) the
+// oldest segment of this log is deleted. Not thread-safe, it belongs to the thread running the
+// protocol.
+struct CaptureLog {
+	std::string prefix;
+
+	size_t segment_size;
+	size_t max_segments;
+
+	uint32_t first_segment;
+	uint32_t segment;
+
+	int fd;
+	uint8_t* map;
+	size_t offset;
+
+	uint64_t records;
+	uint64_t bytes;
+
+	// Records which could not be written
+	uint64_t dropped;
+
+	// Returns nullptr if segments of 'prefix' exist already or the first segment could not be set up
+	static
+	CaptureLog* open(const std::string& prefix, size_t segment_size, size_t max_segments);
+
+	bool append(uint64_t timestamp, CaptureDirection direction, const uint8_t* data, size_t length);
+
+	// Truncates the current segment and deletes the instance
+	void close();
+
+	bool open_segment();
+
+	void close_segment();
+};
+
+// Reads the records of all segments of a capture log in order
+struct CaptureReader {
+	std::string prefix;
+	std::vector<uint32_t> segments;
+	size_t next_segment;
+
+	int fd;
+	const uint8_t* map;
+	size_t size;
+	size_t offset;
+
+	// Returns nullptr if there are no segments
+	static
+	CaptureReader* open(const std::string& prefix);
+
+	// False at the end of the log. 'entry.data' stays valid until the next call.
+	bool next(CaptureEntry& entry);
+
+	bool open_segment();
+
+	void close_segment();
+
+	~CaptureReader();
+};
+
+struct ReplayHandlers {
+	void (* feed)(void* data, const uint8_t* message, size_t length);
+
+	// Invoked from the event loop, must call 'CaptureReplay::pump' from a suitable scope
+	void (* timeout)(void* data);
+
+	// The log has been fed completely or the replay was stopped, the instance is about to be closed
+	void (* done)(void* data, uint64_t fed);
+};
+
+// Feeds the inbound records of a capture log to 'feed'. With a positive 'speed' the original gaps
+// between records are kept, divided by 'speed'; otherwise records are fed as fast as possible in
+// batches, yielding to the event loop in between.
+struct CaptureReplay {
+	ReplayHandlers handlers;
+	void* data;
+
+	CaptureReader* reader;
+	double speed;
+
+	CaptureEntry entry;
+	bool pending;
+
+	// Timestamp of the first record and uv_hrtime() when it was fed
+	uint64_t first_timestamp;
+	uint64_t started_at;
+
+	uint64_t fed;
+
+	// Set while records are being fed and once the replay has been stopped respectively
+	bool pumping;
+	bool stopped;
+
+	uv_timer_t timer;
+
+	static constexpr size_t batch = 1024;
+
+	// Takes ownership of 'reader'
+	static
+	CaptureReplay* create(
+		const ReplayHandlers& handlers,
+		void*                 data,
+		CaptureReader*        reader,
+		double                speed,
+		uv_loop_t*            loop
+	);
+
+	// Feed the records which are due and wait for the next one. Calls 'done' and closes the instance
+	// at the end of the log.
+	void pump();
+
+	void feed_batch();
+
+	// Calls 'done' and closes the instance. From within 'feed', the instance is closed once 'pump'
+	// returns.
+	void stop();
+
+	// Deletes the instance once libuv has closed the timer
+	void close();
+};
+
+#endif
@@ -0,0 +1,347 @@
+#include "codec.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
+// The addon is built for baseline x86-64, AVX2 code is compiled per function and picked at runtime
+#if defined(__x86_64__) && defined(__GNUC__)
+	#define KNXPROTO_BULK_AVX2
+	#include <immintrin.h>
+#endif
+
+static inline
+uint16_t bulk_read16(const uint8_t* input) {
+	return uint16_t(input[0] << 8 | input[1]);
+}
+
+static inline
+void bulk_write16(uint8_t* output, uint16_t value) {
+	output[0] = value >> 8;
+	output[1] = value & 255;
+}
+
+// KNX 2-byte float: sign bit, 4 bit exponent and 11 bit mantissa, the 12 bit two's complement
+// mantissa scaled by 2^exponent yields the value in hundredths
+static inline
+double bulk_float16_value(uint16_t raw) {
+	int32_t mantissa = int32_t(raw & 0x7FF) - int32_t((raw & 0x8000) >> 4);
+	return 0.01 * double(mantissa * (1 << ((raw >> 11) & 15)));
+}
+
+#if defined(__SSE2__)
+
+// Same computation as above for four values, 2^exponent is built from the float exponent bits
+// which keeps the product exact before it is widened
+static inline
+void bulk_float16_sse2(__m128i raw, double* output) {
+	__m128i mantissa = _mm_sub_epi32(
+		_mm_and_si128(raw, _mm_set1_epi32(0x7FF)),
+		_mm_srli_epi32(_mm_and_si128(raw, _mm_set1_epi32(0x8000)), 4)
+	);
+
+	__m128i exponent = _mm_and_si128(_mm_srli_epi32(raw, 11), _mm_set1_epi32(15));
+	__m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(exponent, _mm_set1_epi32(127)), 23));
+
+	__m128 values = _mm_mul_ps(_mm_cvtepi32_ps(mantissa), scale);
+	__m128d hundredth = _mm_set1_pd(0.01);
+
+	_mm_storeu_pd(output,     _mm_mul_pd(_mm_cvtps_pd(values), hundredth));
+	_mm_storeu_pd(output + 2, _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(values, values)), hundredth));
+}
+
+static inline
+__m128i bulk_swap16_sse2(__m128i raw) {
+	return _mm_or_si128(_mm_slli_epi16(raw, 8), _mm_srli_epi16(raw, 8));
+}
+
+static inline
+__m128i bulk_swap32_sse2(__m128i raw) {
+	return bulk_swap16_sse2(_mm_shufflehi_epi16(_mm_shufflelo_epi16(raw, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+#endif
+
+#if defined(KNXPROTO_BULK_AVX2)
+
+__attribute__((target("avx2")))
+static inline
+void bulk_float16_avx2(__m256i raw, double* output) {
+	__m256i mantissa = _mm256_sub_epi32(
+		_mm256_and_si256(raw, _mm256_set1_epi32(0x7FF)),
+		_mm256_srli_epi32(_mm256_and_si256(raw, _mm256_set1_epi32(0x8000)), 4)
+	);
+
+	__m256i exponent = _mm256_and_si256(_mm256_srli_epi32(raw, 11), _mm256_set1_epi32(15));
+	__m256 scale = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(exponent, _mm256_set1_epi32(127)), 23));
+
+	__m256 values = _mm256_mul_ps(_mm256_cvtepi32_ps(mantissa), scale);
+	__m256d hundredth = _mm256_set1_pd(0.01);
+
+	_mm256_storeu_pd(output,     _mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(values)), hundredth));
+	_mm256_storeu_pd(output + 4, _mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(values, 1)), hundredth));
+}
+
+// Decodes the leading multiple of 8 values, yields how many that were
+__attribute__((target("avx2")))
+static
+size_t bulk_decode_float16_avx2(const uint8_t* input, size_t count, double* output) {
+	size_t i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		__m128i raw = bulk_swap16_sse2(_mm_loadu_si128((const __m128i*) (input + i * 2)));
+		bulk_float16_avx2(_mm256_cvtepu16_epi32(raw), output + i);
+	}
+
+	return i;
+}
+
+static
+bool bulk_detect_avx2() {
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+}
+
+static const
+bool bulk_has_avx2 = bulk_detect_avx2();
+
+#endif
+
+void knxproto_bulk_decode_float16(const uint8_t* input, size_t stride, size_t count, double* output) {
+	size_t i = 0;
+
+	// Vectorized paths only apply to densely packed values
+	if (stride == 2) {
+#if defined(KNXPROTO_BULK_AVX2)
+		if (bulk_has_avx2)
+			i = bulk_decode_float16_avx2(input, count, output);
+#endif
+
+#if defined(__SSE2__)
+		__m128i zero = _mm_setzero_si128();
+
+		for (; i + 8 <= count; i += 8) {
+			__m128i raw = bulk_swap16_sse2(_mm_loadu_si128((const __m128i*) (input + i * 2)));
+
+			bulk_float16_sse2(_mm_unpacklo_epi16(raw, zero), output + i);
+			bulk_float16_sse2(_mm_unpackhi_epi16(raw, zero), output + i + 4);
+		}
+#endif
+	}
+
+	for (; i < count; i++)
+		output[i] = bulk_float16_value(bulk_read16(input + i * stride));
+}
+
+void knxproto_bulk_decode_unsigned16(const uint8_t* input, size_t stride, size_t count, double* output) {
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	if (stride == 2) {
+		__m128i zero = _mm_setzero_si128();
+
+		for (; i + 8 <= count; i += 8) {
+			__m128i raw = bulk_swap16_sse2(_mm_loadu_si128((const __m128i*) (input + i * 2)));
+			__m128i lo = _mm_unpacklo_epi16(raw, zero);
+			__m128i hi = _mm_unpackhi_epi16(raw, zero);
+
+			_mm_storeu_pd(output + i,     _mm_cvtepi32_pd(lo));
+			_mm_storeu_pd(output + i + 2, _mm_cvtepi32_pd(_mm_srli_si128(lo, 8)));
+			_mm_storeu_pd(output + i + 4, _mm_cvtepi32_pd(hi));
+			_mm_storeu_pd(output + i + 6, _mm_cvtepi32_pd(_mm_srli_si128(hi, 8)));
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+		output[i] = bulk_read16(input + i * stride);
+}
+
+void knxproto_bulk_decode_float32(const uint8_t* input, size_t stride, size_t count, double* output) {
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	if (stride == 4) {
+		for (; i + 4 <= count; i += 4) {
+			__m128 values = _mm_castsi128_ps(bulk_swap32_sse2(_mm_loadu_si128((const __m128i*) (input + i * 4))));
+
+			_mm_storeu_pd(output + i,     _mm_cvtps_pd(values));
+			_mm_storeu_pd(output + i + 2, _mm_cvtps_pd(_mm_movehl_ps(values, values)));
+		}
+	}
+#endif
+
+	for (; i < count; i++) {
+		const uint8_t* raw = input + i * stride;
+		uint32_t bits = uint32_t(raw[0]) << 24 | uint32_t(raw[1]) << 16 | uint32_t(raw[2]) << 8 | raw[3];
+
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+
+		output[i] = value;
+	}
+}
+
+static inline
+uint16_t bulk_float16_raw(double value) {
+	// NaN becomes 0x7FFF, which DPT 9 reserves for invalid data
+	if (std::isnan(value))
+		return 0x7FFF;
+
+	double mantissa = value * 100;
+	uint16_t exponent = 0;
+
+	while ((mantissa < -2048 || mantissa > 2047) && exponent < 15) {
+		mantissa /= 2;
+		exponent++;
+	}
+
+	// Values beyond the largest exponent, infinities included, saturate
+	int32_t rounded =
+		mantissa <= -2048 ? -2048 : (mantissa >= 2047 ? 2047 : int32_t(std::lround(mantissa)));
+
+	return (rounded < 0 ? 0x8000 : 0) | (exponent << 11) | (rounded & 0x7FF);
+}
+
+#if defined(__SSE2__)
+
+// Two values of the scalar computation above, yields them in the lower two 32 bit lanes
+static inline
+__m128i bulk_float16_raw_sse2(__m128d value) {
+	__m128d mantissa = _mm_mul_pd(value, _mm_set1_pd(100));
+
+	// The exponent is the number of halvings that leave the mantissa out of range. With the
+	// mantissa in [2^p, 2^(p + 1)) every exponent below p - 11 is too small and p - 9 always
+	// suffices, so starting at p - 11 at most two steps remain. The 16 bit min/max keep the
+	// 64 bit lanes intact as long as their values fit 16 bits.
+	__m128i exponent = _mm_sub_epi64(
+		_mm_and_si128(_mm_srli_epi64(_mm_castpd_si128(mantissa), 52), _mm_set1_epi64x(0x7FF)),
+		_mm_set1_epi64x(1023 + 11)
+	);
+
+	exponent = _mm_min_epi16(_mm_max_epi16(exponent, _mm_setzero_si128()), _mm_set1_epi64x(15));
+
+	for (int step = 0; step < 2; step++) {
+		__m128d scale = _mm_castsi128_pd(_mm_slli_epi64(_mm_add_epi64(exponent, _mm_set1_epi64x(1023)), 52));
+
+		__m128d outside = _mm_or_pd(
+			_mm_cmplt_pd(mantissa, _mm_mul_pd(scale, _mm_set1_pd(-2048))),
+			_mm_cmpgt_pd(mantissa, _mm_mul_pd(scale, _mm_set1_pd(2047)))
+		);
+
+		exponent = _mm_sub_epi64(exponent, _mm_castpd_si128(outside));
+	}
+
+	exponent = _mm_min_epi16(exponent, _mm_set1_epi64x(15));
+
+	// Dividing by 2^exponent is exact, the bits of 2^-exponent are put together directly
+	__m128i scale_bits = _mm_slli_epi64(_mm_sub_epi64(_mm_set1_epi64x(1023), exponent), 52);
+	__m128d scaled = _mm_mul_pd(mantissa, _mm_castsi128_pd(scale_bits));
+	scaled = _mm_min_pd(_mm_max_pd(scaled, _mm_set1_pd(-2048)), _mm_set1_pd(2047));
+
+	exponent = _mm_shuffle_epi32(exponent, _MM_SHUFFLE(3, 3, 2, 0));
+
+	// Round half away from zero like 'lround', the truncated part is exact below 2^11
+	__m128i truncated = _mm_cvttpd_epi32(scaled);
+	__m128d fraction = _mm_sub_pd(scaled, _mm_cvtepi32_pd(truncated));
+
+	__m128i up = _mm_shuffle_epi32(_mm_castpd_si128(_mm_cmpge_pd(fraction, _mm_set1_pd(0.5))), _MM_SHUFFLE(3, 3, 2, 0));
+	__m128i down = _mm_shuffle_epi32(_mm_castpd_si128(_mm_cmple_pd(fraction, _mm_set1_pd(-0.5))), _MM_SHUFFLE(3, 3, 2, 0));
+	__m128i rounded = _mm_add_epi32(_mm_sub_epi32(truncated, up), down);
+
+	__m128i raw = _mm_or_si128(
+		_mm_or_si128(_mm_and_si128(_mm_srai_epi32(rounded, 16), _mm_set1_epi32(0x8000)), _mm_slli_epi32(exponent, 11)),
+		_mm_and_si128(rounded, _mm_set1_epi32(0x7FF))
+	);
+
+	__m128i nan = _mm_shuffle_epi32(_mm_castpd_si128(_mm_cmpunord_pd(value, value)), _MM_SHUFFLE(3, 3, 2, 0));
+	return _mm_or_si128(_mm_andnot_si128(nan, raw), _mm_and_si128(nan, _mm_set1_epi32(0x7FFF)));
+}
+
+// Eight 16 bit values from two vectors holding four each in their 32 bit lanes, big endian
+static inline
+__m128i bulk_pack16_sse2(__m128i lo, __m128i hi) {
+	// Sign extension keeps the signed saturation of the pack from touching the lower 16 bits
+	lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+	hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+
+	return bulk_swap16_sse2(_mm_packs_epi32(lo, hi));
+}
+
+#endif
+
+void knxproto_bulk_encode_float16(const double* input, size_t count, uint8_t* output) {
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	for (; i + 8 <= count; i += 8) {
+		__m128i lo = _mm_unpacklo_epi64(
+			bulk_float16_raw_sse2(_mm_loadu_pd(input + i)),
+			bulk_float16_raw_sse2(_mm_loadu_pd(input + i + 2))
+		);
+
+		__m128i hi = _mm_unpacklo_epi64(
+			bulk_float16_raw_sse2(_mm_loadu_pd(input + i + 4)),
+			bulk_float16_raw_sse2(_mm_loadu_pd(input + i + 6))
+		);
+
+		_mm_storeu_si128((__m128i*) (output + i * 2), bulk_pack16_sse2(lo, hi));
+	}
+#endif
+
+	for (; i < count; i++)
+		bulk_write16(output + i * 2, bulk_float16_raw(input[i]));
+}
+
+void knxproto_bulk_encode_unsigned16(const double* input, size_t count, uint8_t* output) {
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	// 'max' yields its second operand for NaN, which therefore becomes zero like below
+	__m128d zero = _mm_setzero_pd();
+	__m128d limit = _mm_set1_pd(65535);
+
+	for (; i + 8 <= count; i += 8) {
+		__m128i values[4];
+
+		for (int k = 0; k < 4; k++)
+			values[k] = _mm_cvttpd_epi32(_mm_min_pd(_mm_max_pd(_mm_loadu_pd(input + i + k * 2), zero), limit));
+
+		__m128i lo = _mm_unpacklo_epi64(values[0], values[1]);
+		__m128i hi = _mm_unpacklo_epi64(values[2], values[3]);
+
+		_mm_storeu_si128((__m128i*) (output + i * 2), bulk_pack16_sse2(lo, hi));
+	}
+#endif
+
+	for (; i < count; i++) {
+		double value = input[i];
+		bulk_write16(output + i * 2, !(value > 0) ? 0 : (value >= 65535 ? 65535 : uint16_t(value)));
+	}
+}
+
+void knxproto_bulk_encode_float32(const double* input, size_t count, uint8_t* output) {
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	for (; i + 4 <= count; i += 4) {
+		__m128 values = _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(input + i)), _mm_cvtpd_ps(_mm_loadu_pd(input + i + 2)));
+		_mm_storeu_si128((__m128i*) (output + i * 4), bulk_swap32_sse2(_mm_castps_si128(values)));
+	}
+#endif
+
+	for (; i < count; i++) {
+		float value = input[i];
+
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		output[i * 4]     = bits >> 24;
+		output[i * 4 + 1] = (bits >> 16) & 255;
+		output[i * 4 + 2] = (bits >> 8) & 255;
+		output[i * 4 + 3] = bits & 255;
+	}
+}
@@ -0,0 +1,18 @@
+#ifndef KNXPROTO_LIB_CODEC_H_
+#define KNXPROTO_LIB_CODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Decoders and encoders for many values at once, independent of V8. Decoding reads 'count' values
+// spaced 'stride' bytes apart, encoding writes them back to back.
+
+void knxproto_bulk_decode_float16(const uint8_t* input, size_t stride, size_t count, double* output);
+void knxproto_bulk_decode_float32(const uint8_t* input, size_t stride, size_t count, double* output);
+void knxproto_bulk_decode_unsigned16(const uint8_t* input, size_t stride, size_t count, double* output);
+
+void knxproto_bulk_encode_float16(const double* input, size_t count, uint8_t* output);
+void knxproto_bulk_encode_float32(const double* input, size_t count, uint8_t* output);
+void knxproto_bulk_encode_unsigned16(const double* input, size_t count, uint8_t* output);
+
+#endif
@@ -0,0 +1,123 @@
+#include "columns.hpp"
+
+using namespace v8;
+
+// The typed array is only (re)created if 'object' is given, otherwise just the pointer is updated
+template <typename T, typename A>
+static
+T* columns_attach(
+	Isolate*           isolate,
+	Local<Object>      object,
+	const char*        name,
+	Local<ArrayBuffer> buffer,
+	size_t&            offset,
+	uint32_t           capacity
+) {
+	if (!object.IsEmpty())
+		object->Set(String::NewFromUtf8(isolate, name), A::New(buffer, offset, capacity));
+
+	T* column = (T*) ((uint8_t*) buffer->GetContents().Data() + offset);
+	offset += sizeof(T) * capacity;
+
+	return column;
+}
+
+FrameColumns* FrameColumns::create(Isolate* isolate, uint32_t capacity, uint32_t arena_size) {
+	FrameColumns* columns = new FrameColumns;
+	columns->capacity = capacity;
+	columns->arena_size = arena_size;
+
+	columns->object.Reset(isolate, Object::New(isolate));
+	columns->attach(isolate);
+	columns->reset();
+	columns->publish(isolate);
+
+	return columns;
+}
+
+void FrameColumns::attach(Isolate* isolate) {
+	Local<ArrayBuffer> fields = Local<ArrayBuffer>::New(isolate, fields_buffer);
+	Local<ArrayBuffer> payloads = Local<ArrayBuffer>::New(isolate, arena_buffer);
+
+	// Detached buffers report a length of zero
+	bool detached = fields.IsEmpty() || payloads.IsEmpty() ||
+	                fields->ByteLength() != size_t(capacity) * 15 ||
+	                payloads->ByteLength() != arena_size;
+
+	Local<Object> object;
+
+	if (detached) {
+		// Wider columns come first, so that every column is aligned
+		fields = ArrayBuffer::New(isolate, size_t(capacity) * 15);
+		payloads = ArrayBuffer::New(isolate, arena_size);
+
+		fields_buffer.Reset(isolate, fields);
+		arena_buffer.Reset(isolate, payloads);
+
+		object = Local<Object>::New(isolate, this->object);
+	}
+
+	size_t offset = 0;
+
+	payload_offset = columns_attach<uint32_t, Uint32Array>(isolate, object, "payloadOffset", fields, offset, capacity);
+	source         = columns_attach<uint16_t, Uint16Array>(isolate, object, "source",        fields, offset, capacity);
+	destination    = columns_attach<uint16_t, Uint16Array>(isolate, object, "destination",   fields, offset, capacity);
+	apci           = columns_attach<uint16_t, Uint16Array>(isolate, object, "apci",          fields, offset, capacity);
+	payload_length = columns_attach<uint16_t, Uint16Array>(isolate, object, "payloadLength", fields, offset, capacity);
+	service        = columns_attach<uint8_t,  Uint8Array>(isolate,  object, "service",       fields, offset, capacity);
+	tpci           = columns_attach<uint8_t,  Uint8Array>(isolate,  object, "tpci",          fields, offset, capacity);
+	priority       = columns_attach<uint8_t,  Uint8Array>(isolate,  object, "priority",      fields, offset, capacity);
+
+	offset = 0;
+	arena = columns_attach<uint8_t, Uint8Array>(isolate, object, "payload", payloads, offset, arena_size);
+}
+
+FrameColumns::~FrameColumns() {
+	object.Reset();
+	fields_buffer.Reset();
+	arena_buffer.Reset();
+}
+
+void FrameColumns::reset() {
+	length = 0;
+	arena_used = 0;
+	dropped = 0;
+}
+
+bool FrameColumns::append(const knx_cemi& frame) {
+	const knx_ldata& ldata = frame.payload.ldata;
+
+	bool has_data = ldata.tpdu.tpci == KNX_TPCI_UNNUMBERED_DATA || ldata.tpdu.tpci == KNX_TPCI_NUMBERED_DATA;
+
+	const uint8_t* payload = has_data ? ldata.tpdu.info.data.payload : nullptr;
+	size_t payload_size = has_data ? ldata.tpdu.info.data.length : 0;
+
+	if (length >= capacity || payload_size > arena_size - arena_used) {
+		dropped++;
+		return false;
+	}
+
+	source[length]         = ldata.source;
+	destination[length]    = ldata.destination;
+	service[length]        = frame.service;
+	priority[length]       = ldata.control1.priority;
+	tpci[length]           = ldata.tpdu.tpci;
+	apci[length]           = has_data ? ldata.tpdu.info.data.apci : 0;
+	payload_offset[length] = arena_used;
+	payload_length[length] = payload_size;
+
+	for (size_t i = 0; i < payload_size; i++)
+		arena[arena_used + i] = payload[i];
+
+	arena_used += payload_size;
+	length++;
+
+	return true;
+}
+
+void FrameColumns::publish(Isolate* isolate) {
+	Local<Object> local = Local<Object>::New(isolate, object);
+
+	local->Set(String::NewFromUtf8(isolate, "length"),  Integer::NewFromUnsigned(isolate, length));
+	local->Set(String::NewFromUtf8(isolate, "dropped"), Integer::NewFromUnsigned(isolate, dropped));
+}
@@ -0,0 +1,59 @@
+#ifndef KNXPROTO_LIB_COLUMNS_H_
+#define KNXPROTO_LIB_COLUMNS_H_
+
+extern "C" {
+	#include <knxproto/proto/cemi.h>
+}
+
+#include <v8.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// Typed arrays into which received L_Data frames are decoded column by column. The arrays are
+// allocated once and handed to JavaScript, each batch overwrites them starting at index 0.
+struct FrameColumns {
+	v8::Persistent<v8::Object> object;
+
+	// Backing stores of the fixed size columns and of the payload arena
+	v8::Persistent<v8::ArrayBuffer> fields_buffer;
+	v8::Persistent<v8::ArrayBuffer> arena_buffer;
+
+	uint32_t capacity;
+	size_t arena_size;
+
+	uint16_t* source;
+	uint16_t* destination;
+	// The APCI is 10 bits wide, hence 16 bits rather than one byte per frame
+	uint16_t* apci;
+	uint32_t* payload_offset;
+	uint16_t* payload_length;
+	uint8_t*  service;
+	uint8_t*  tpci;
+	uint8_t*  priority;
+	uint8_t*  arena;
+
+	uint32_t length;
+	size_t arena_used;
+	uint32_t dropped;
+
+	// Neither size may be zero, an empty backing store could not be told apart from a detached one
+	static
+	FrameColumns* create(v8::Isolate* isolate, uint32_t capacity, uint32_t arena_size);
+
+	~FrameColumns();
+
+	// Fetch the column pointers from the backing stores, which is required before every batch as
+	// JavaScript may have detached them. Detached buffers are replaced along with their arrays.
+	void attach(v8::Isolate* isolate);
+
+	void reset();
+
+	// Returns false if the frame did not fit
+	bool append(const knx_cemi& frame);
+
+	// Update 'length' and 'dropped' of the JavaScript object
+	void publish(v8::Isolate* isolate);
+};
+
+#endif
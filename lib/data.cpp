@@ -1,19 +1,18 @@
 #include "data.hpp"
-
-#include <algorithm>
+#include "pool.hpp"
 
 #include <node_buffer.h>
 
 using namespace jawra;
 using namespace v8;
 
-void knxproto_free_buffer(char* buffer, void*) {
-	delete[] buffer;
+void knxproto_free_buffer(char* buffer, void* length) {
+	knxproto_pool_release(buffer, (size_t) length);
 }
 
 Handle<Value> knxproto_make_buffer(char* buffer, size_t length) {
 	Isolate* isolate = Isolate::GetCurrent();
-	auto mb = node::Buffer::New(isolate, buffer, length, knxproto_free_buffer, nullptr);
+	auto mb = node::Buffer::New(isolate, buffer, length, knxproto_free_buffer, (void*) length);
 
 	if (mb.IsEmpty())
 		return Null(isolate);
@@ -21,67 +20,32 @@ Handle<Value> knxproto_make_buffer(char* buffer, size_t length) {
 		return mb.ToLocalChecked();
 }
 
-#define KNXPROTO_PARSE_APDU_DEF(n, c, r) KNXPROTO_PARSE_APDU_DECL(n) { \
-	knx_##n value; \
-	\
-	if (!payload.data || payload.length < knx_dpt_size(c) || \
-	    !knx_dpt_from_apdu((const uint8_t*) payload.data, payload.length, c, &value)) \
-			return Null(Isolate::GetCurrent()); \
-	\
-	return pack<r>(Isolate::GetCurrent(), value); \
-}
+Handle<Value> knxproto_buffer_pool_stats() {
+	Isolate* isolate = Isolate::GetCurrent();
+	knxproto_pool_stats stats = knxproto_pool_get_stats();
 
-KNXPROTO_PARSE_APDU_DEF(unsigned8,  KNX_DPT_UNSIGNED8,  uint32_t)
-KNXPROTO_PARSE_APDU_DEF(unsigned16, KNX_DPT_UNSIGNED16, uint32_t)
-KNXPROTO_PARSE_APDU_DEF(unsigned32, KNX_DPT_UNSIGNED32, uint32_t)
+	Local<Array> classes = Array::New(isolate, knxproto_pool_classes);
 
-KNXPROTO_PARSE_APDU_DEF(signed8,    KNX_DPT_SIGNED8,    int32_t)
-KNXPROTO_PARSE_APDU_DEF(signed16,   KNX_DPT_SIGNED16,   int32_t)
-KNXPROTO_PARSE_APDU_DEF(signed32,   KNX_DPT_SIGNED32,   int32_t)
+	for (size_t i = 0; i < knxproto_pool_classes; i++) {
+		const knxproto_pool_class_stats& class_stats = stats.classes[i];
+		ObjectWrapper class_wrapper(isolate);
 
-KNXPROTO_PARSE_APDU_DEF(float16,    KNX_DPT_FLOAT16,    double)
-KNXPROTO_PARSE_APDU_DEF(float32,    KNX_DPT_FLOAT32,    double)
+		class_wrapper.set("blockSize",   (uint32_t) class_stats.block_size);
+		class_wrapper.set("slabs",       (uint32_t) class_stats.slabs);
+		class_wrapper.set("inUse",       (uint32_t) class_stats.in_use);
+		class_wrapper.set("free",        (uint32_t) class_stats.free);
+		class_wrapper.set("allocations", (double)   class_stats.allocations);
+		class_wrapper.set("reuses",      (double)   class_stats.reuses);
 
-KNXPROTO_PARSE_APDU_DEF(bool,       KNX_DPT_BOOL,       bool)
-KNXPROTO_PARSE_APDU_DEF(char,       KNX_DPT_CHAR,       char)
+		Local<Value> class_value = class_wrapper;
+		classes->Set(i, class_value);
+	}
 
-KNXPROTO_PARSE_APDU_DEF(cvalue,     KNX_DPT_CVALUE,     knx_cvalue)
-KNXPROTO_PARSE_APDU_DEF(cstep,      KNX_DPT_CSTEP,      knx_cstep)
-KNXPROTO_PARSE_APDU_DEF(timeofday,  KNX_DPT_TIMEOFDAY,  knx_timeofday)
-KNXPROTO_PARSE_APDU_DEF(date,       KNX_DPT_DATE,       knx_date)
+	ObjectWrapper wrapper(isolate);
 
-#define KNXPROTO_MAKE_APDU_DEF_S(n, c, t) KNXPROTO_MAKE_APDU_DECL(n, t) { \
-	size_t length = knx_dpt_size(c); \
-	char* buffer = new char[length]; \
-	std::fill(buffer, buffer + length, 0); \
-	knx_dpt_to_apdu((uint8_t*) buffer, c, &value); \
-	return knxproto_make_buffer(buffer, length); \
-}
+	wrapper.set("classes",         Local<Value>(classes));
+	wrapper.set("heapAllocations", (double)   stats.heap_allocations);
+	wrapper.set("heapInUse",       (uint32_t) stats.heap_in_use);
 
-#define KNXPROTO_MAKE_APDU_DEF(n, c, t) KNXPROTO_MAKE_APDU_DECL(n, t) { \
-	size_t length = knx_dpt_size(c); \
-	char* buffer = new char[length]; \
-	std::fill(buffer, buffer + length, 0); \
-	knx_##n value2 = (knx_##n) value; \
-	knx_dpt_to_apdu((uint8_t*) buffer, c, &value2); \
-	return knxproto_make_buffer(buffer, length); \
+	return wrapper;
 }
-
-KNXPROTO_MAKE_APDU_DEF(unsigned8,  KNX_DPT_UNSIGNED8,  uint32_t)
-KNXPROTO_MAKE_APDU_DEF(unsigned16, KNX_DPT_UNSIGNED16, uint32_t)
-KNXPROTO_MAKE_APDU_DEF(unsigned32, KNX_DPT_UNSIGNED32, uint32_t)
-
-KNXPROTO_MAKE_APDU_DEF(signed8,    KNX_DPT_SIGNED8,    int32_t)
-KNXPROTO_MAKE_APDU_DEF(signed16,   KNX_DPT_SIGNED16,   int32_t)
-KNXPROTO_MAKE_APDU_DEF(signed32,   KNX_DPT_SIGNED32,   int32_t)
-
-KNXPROTO_MAKE_APDU_DEF(float16,   KNX_DPT_FLOAT16,    double)
-KNXPROTO_MAKE_APDU_DEF(float32,   KNX_DPT_FLOAT32,    double)
-
-KNXPROTO_MAKE_APDU_DEF(bool,       KNX_DPT_BOOL,       bool)
-KNXPROTO_MAKE_APDU_DEF(char,       KNX_DPT_CHAR,       char)
-
-KNXPROTO_MAKE_APDU_DEF_S(cvalue,     KNX_DPT_CVALUE,     knx_cvalue)
-KNXPROTO_MAKE_APDU_DEF_S(cstep,      KNX_DPT_CSTEP,      knx_cstep)
-KNXPROTO_MAKE_APDU_DEF_S(timeofday,  KNX_DPT_TIMEOFDAY,  knx_timeofday)
-KNXPROTO_MAKE_APDU_DEF_S(date,       KNX_DPT_DATE,       knx_date)
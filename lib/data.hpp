@@ -9,10 +9,13 @@ extern "C" {
 #include <jawra/functions.hpp>
 #include <jawra/values.hpp>
 
-void knxproto_free_buffer(char* buffer, void*);
+void knxproto_free_buffer(char* buffer, void* length);
 
+// 'buffer' must come from 'knxproto_pool_alloc'
 v8::Handle<v8::Value> knxproto_make_buffer(char* buffer, size_t length);
 
+v8::Handle<v8::Value> knxproto_buffer_pool_stats();
+
 namespace jawra {
 	template <>
 	struct ValueWrapper<char> {
@@ -194,46 +197,4 @@ namespace jawra {
 	};
 }
 
-#define KNXPROTO_PARSE_APDU_DECL(n) v8::Handle<v8::Value> knxproto_parse_##n(jawra::Buffer payload)
-
-KNXPROTO_PARSE_APDU_DECL(unsigned8);
-KNXPROTO_PARSE_APDU_DECL(unsigned16);
-KNXPROTO_PARSE_APDU_DECL(unsigned32);
-
-KNXPROTO_PARSE_APDU_DECL(signed8);
-KNXPROTO_PARSE_APDU_DECL(signed16);
-KNXPROTO_PARSE_APDU_DECL(signed32);
-
-KNXPROTO_PARSE_APDU_DECL(float16);
-KNXPROTO_PARSE_APDU_DECL(float32);
-
-KNXPROTO_PARSE_APDU_DECL(bool);
-KNXPROTO_PARSE_APDU_DECL(char);
-
-KNXPROTO_PARSE_APDU_DECL(cvalue);
-KNXPROTO_PARSE_APDU_DECL(cstep);
-KNXPROTO_PARSE_APDU_DECL(timeofday);
-KNXPROTO_PARSE_APDU_DECL(date);
-
-#define KNXPROTO_MAKE_APDU_DECL(n, t) v8::Handle<v8::Value> knxproto_make_##n(t value)
-
-KNXPROTO_MAKE_APDU_DECL(unsigned8, uint32_t);
-KNXPROTO_MAKE_APDU_DECL(unsigned16, uint32_t);
-KNXPROTO_MAKE_APDU_DECL(unsigned32, uint32_t);
-
-KNXPROTO_MAKE_APDU_DECL(signed8, int32_t);
-KNXPROTO_MAKE_APDU_DECL(signed16, int32_t);
-KNXPROTO_MAKE_APDU_DECL(signed32, int32_t);
-
-KNXPROTO_MAKE_APDU_DECL(float16, double);
-KNXPROTO_MAKE_APDU_DECL(float32, double);
-
-KNXPROTO_MAKE_APDU_DECL(bool, bool);
-KNXPROTO_MAKE_APDU_DECL(char, char);
-
-KNXPROTO_MAKE_APDU_DECL(cvalue, knx_cvalue);
-KNXPROTO_MAKE_APDU_DECL(cstep, knx_cstep);
-KNXPROTO_MAKE_APDU_DECL(timeofday, knx_timeofday);
-KNXPROTO_MAKE_APDU_DECL(date, knx_date);
-
 #endif
@@ -0,0 +1,76 @@
+#include "delivery.hpp"
+
+#include <algorithm>
+
+DeliveryBuffer* DeliveryBuffer::create(
+	void (*    flush)(void* data),
+	void*      data,
+	size_t     max_events,
+	uint64_t   max_delay_us,
+	uv_loop_t* loop
+) {
+	DeliveryBuffer* buffer = new DeliveryBuffer;
+
+	buffer->flush = flush;
+	buffer->data = data;
+
+	buffer->max_events = std::max<size_t>(max_events, 1);
+	buffer->max_delay = max_delay_us * 1000;
+	buffer->first_at = 0;
+
+	buffer->events.reserve(buffer->max_events);
+
+	// Check handles run right after the loop has polled for I/O, once per turn
+	uv_check_init(loop, &buffer->check);
+	uv_unref((uv_handle_t*) &buffer->check);
+	buffer->check.data = buffer;
+
+	uv_timer_init(loop, &buffer->timer);
+	uv_unref((uv_handle_t*) &buffer->timer);
+	buffer->timer.data = buffer;
+
+	buffer->open_handles = 2;
+
+	return buffer;
+}
+
+bool DeliveryBuffer::push(const ProtocolMessage& event) {
+	if (events.empty()) {
+		first_at = uv_hrtime();
+
+		uv_check_start(&check, [](uv_check_t* check) {
+			DeliveryBuffer* buffer = (DeliveryBuffer*) check->data;
+			buffer->flush(buffer->data);
+		});
+
+		// libuv timers count milliseconds, rounding up keeps the timer from firing early
+		uv_timer_start(&timer, [](uv_timer_t* timer) {
+			DeliveryBuffer* buffer = (DeliveryBuffer*) timer->data;
+			buffer->flush(buffer->data);
+		}, (max_delay + 999999) / 1000000, 0);
+	}
+
+	events.push_back(event);
+
+	return events.size() >= max_events || uv_hrtime() - first_at >= max_delay;
+}
+
+void DeliveryBuffer::clear() {
+	events.clear();
+	uv_check_stop(&check);
+	uv_timer_stop(&timer);
+}
+
+void DeliveryBuffer::close() {
+	clear();
+
+	auto closed = [](uv_handle_t* handle) {
+		DeliveryBuffer* buffer = (DeliveryBuffer*) handle->data;
+
+		if (--buffer->open_handles == 0)
+			delete buffer;
+	};
+
+	uv_close((uv_handle_t*) &check, closed);
+	uv_close((uv_handle_t*) &timer, closed);
+}
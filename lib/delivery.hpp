@@ -0,0 +1,53 @@
+#ifndef KNXPROTO_LIB_DELIVERY_H_
+#define KNXPROTO_LIB_DELIVERY_H_
+
+#include "message.hpp"
+
+#include <uv.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Events held back for JavaScript, which receives them at once at the end of the event loop turn,
+// or earlier once 'max_events' have been gathered or the oldest has waited for 'max_delay'.
+struct DeliveryBuffer {
+	// Invoked from the event loop, must hand 'events' to JavaScript and 'clear' the buffer
+	void (* flush)(void* data);
+	void* data;
+
+	std::vector<ProtocolMessage> events;
+
+	size_t max_events;
+
+	// Nanoseconds
+	uint64_t max_delay;
+	uint64_t first_at;
+
+	uv_check_t check;
+
+	// Runs for 'max_delay' from the first held back event, for when the turn does not end in time
+	uv_timer_t timer;
+
+	// Handles yet to be closed by 'close'
+	int open_handles;
+
+	static
+	DeliveryBuffer* create(
+		void (*    flush)(void* data),
+		void*      data,
+		size_t     max_events,
+		uint64_t   max_delay_us,
+		uv_loop_t* loop
+	);
+
+	// Returns true if the buffer is due to be flushed right away
+	bool push(const ProtocolMessage& event);
+
+	void clear();
+
+	// Deletes the instance once libuv has closed both handles
+	void close();
+};
+
+#endif
@@ -0,0 +1,386 @@
+#include "dpt.hpp"
+#include "pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace jawra;
+using namespace v8;
+
+using DptUnpack = Handle<Value> (*)(const uint8_t* apdu, size_t length);
+using DptPack = Handle<Value> (*)(Local<Value> value);
+using DptWrite = size_t (*)(Local<Value> value, uint8_t* apdu, size_t space);
+using DptEncode = size_t (*)(const void* value, uint8_t* apdu, size_t space);
+
+// Encode into a new Buffer by means of the codec's 'write'
+template <typename C>
+static
+Handle<Value> dpt_pack_with(Local<Value> input, size_t length) {
+	char* buffer = knxproto_pool_alloc(length);
+
+	if (C::write(input, (uint8_t*) buffer, length) == 0) {
+		knxproto_pool_release(buffer, length);
+		return Null(Isolate::GetCurrent());
+	}
+
+	return knxproto_make_buffer(buffer, length);
+}
+
+// Codec backed by libknxproto
+template <knx_dpt C, typename T, typename R>
+struct DptLibCodec {
+	static
+	Handle<Value> unpack(const uint8_t* apdu, size_t length) {
+		T value;
+
+		if (!apdu || length < knx_dpt_size(C) || !knx_dpt_from_apdu(apdu, length, C, &value))
+			return Null(Isolate::GetCurrent());
+
+		return jawra::pack<R>(Isolate::GetCurrent(), value);
+	}
+
+	static
+	size_t encode(const R& input, uint8_t* apdu, size_t space) {
+		size_t length = knx_dpt_size(C);
+
+		if (space < length)
+			return 0;
+
+		T value = (T) input;
+
+		std::fill(apdu, apdu + length, 0);
+		knx_dpt_to_apdu(apdu, C, &value);
+
+		return length;
+	}
+
+	static
+	size_t write(Local<Value> input, uint8_t* apdu, size_t space) {
+		if (!ValueWrapper<R>::check(input))
+			return 0;
+
+		return encode(ValueWrapper<R>::unpack(input), apdu, space);
+	}
+
+	static
+	Handle<Value> pack(Local<Value> input) {
+		return dpt_pack_with<DptLibCodec>(input, knx_dpt_size(C));
+	}
+
+	// 'encode' for a pointer to an already converted value
+	static
+	size_t encode_value(const void* input, uint8_t* apdu, size_t space) {
+		return encode(*(const R*) input, apdu, space);
+	}
+};
+
+// Codec for formats which libknxproto lacks. 'F' converts between its 'Type' and the 'size' bytes
+// following the first APDU octet, its 'encode' fails for values the format can't represent.
+template <typename F>
+struct DptFormatCodec {
+	static
+	Handle<Value> unpack(const uint8_t* apdu, size_t length) {
+		if (!apdu || length < F::size + 1)
+			return Null(Isolate::GetCurrent());
+
+		typename F::Type value;
+		F::decode(apdu + 1, value);
+
+		return jawra::pack<typename F::Type>(Isolate::GetCurrent(), value);
+	}
+
+	static
+	size_t write(Local<Value> input, uint8_t* apdu, size_t space) {
+		if (space < F::size + 1 || !ValueWrapper<typename F::Type>::check(input))
+			return 0;
+
+		typename F::Type value = ValueWrapper<typename F::Type>::unpack(input);
+
+		std::fill(apdu, apdu + F::size + 1, 0);
+
+		return F::encode(value, apdu + 1) ? F::size + 1 : 0;
+	}
+
+	static
+	Handle<Value> pack(Local<Value> input) {
+		return dpt_pack_with<DptFormatCodec>(input, F::size + 1);
+	}
+};
+
+// 5.001 scaling (0-100 %) and 5.003 angle (0-360 degrees)
+template <unsigned Range>
+struct DptRatio {
+	using Type = double;
+	static constexpr size_t size = 1;
+
+	static
+	void decode(const uint8_t* data, double& value) {
+		value = data[0] * double(Range) / 255;
+	}
+
+	// Out of range values saturate, NaN has no representation
+	static
+	bool encode(double value, uint8_t* data) {
+		if (std::isnan(value))
+			return false;
+
+		double raw = std::round(value * 255 / Range);
+		data[0] = raw <= 0 ? 0 : (raw >= 255 ? 255 : uint8_t(raw));
+
+		return true;
+	}
+};
+
+// 16.x
+struct DptString {
+	using Type = knxproto_string;
+	static constexpr size_t size = 14;
+
+	static
+	void decode(const uint8_t* data, knxproto_string& value) {
+		std::copy(data, data + size, (uint8_t*) value.data);
+	}
+
+	static
+	bool encode(const knxproto_string& value, uint8_t* data) {
+		std::copy(value.data, value.data + size, data);
+		return true;
+	}
+};
+
+// 19.001
+struct DptDateTime {
+	using Type = knxproto_datetime;
+	static constexpr size_t size = 8;
+
+	static
+	void decode(const uint8_t* data, knxproto_datetime& value) {
+		value.year        = 1900 + data[0];
+		value.month       = data[1] & 15;
+		value.day         = data[2] & 31;
+		value.day_of_week = data[3] >> 5;
+		value.hour        = data[3] & 31;
+		value.minute      = data[4] & 63;
+		value.second      = data[5] & 63;
+		value.flags       = uint16_t(data[6] << 8 | data[7]);
+	}
+
+	static
+	bool encode(const knxproto_datetime& value, uint8_t* data) {
+		data[0] = value.year < 1900 ? 0 : std::min(value.year - 1900, 255);
+		data[1] = value.month & 15;
+		data[2] = value.day & 31;
+		data[3] = (value.day_of_week & 7) << 5 | (value.hour & 31);
+		data[4] = value.minute & 63;
+		data[5] = value.second & 63;
+		data[6] = value.flags >> 8;
+		data[7] = value.flags & 255;
+
+		return true;
+	}
+};
+
+// 232.600
+struct DptRGB {
+	using Type = knxproto_rgb;
+	static constexpr size_t size = 3;
+
+	static
+	void decode(const uint8_t* data, knxproto_rgb& value) {
+		value = {data[0], data[1], data[2]};
+	}
+
+	static
+	bool encode(const knxproto_rgb& value, uint8_t* data) {
+		data[0] = value.red;
+		data[1] = value.green;
+		data[2] = value.blue;
+
+		return true;
+	}
+};
+
+struct DptEntry {
+	uint16_t main;
+
+	// Zero matches every sub number
+	uint16_t sub;
+
+	// libknxproto type behind the codec, -1 for the formats implemented here
+	int16_t type;
+
+	DptUnpack unpack;
+	DptPack pack;
+	DptWrite write;
+
+	// Only set for libknxproto types, see 'knxproto_dpt_type'
+	DptEncode encode;
+};
+
+#define KNXPROTO_DPT_LIB_CODEC(c) \
+	DptLibCodec<c, knxproto_dpt_type<c>::type, knxproto_dpt_type<c>::repr>
+
+#define KNXPROTO_DPT_LIB(m, s, c) \
+	{m, s, c, &KNXPROTO_DPT_LIB_CODEC(c)::unpack, &KNXPROTO_DPT_LIB_CODEC(c)::pack, \
+	 &KNXPROTO_DPT_LIB_CODEC(c)::write, &KNXPROTO_DPT_LIB_CODEC(c)::encode_value}
+
+#define KNXPROTO_DPT_FORMAT(m, s, f) \
+	{m, s, -1, &DptFormatCodec<f>::unpack, &DptFormatCodec<f>::pack, &DptFormatCodec<f>::write, nullptr}
+
+// Entries with the same main number must be adjacent, specific sub numbers before the wildcard
+static constexpr
+DptEntry dpt_entries[] = {
+	KNXPROTO_DPT_LIB(1,  0, KNX_DPT_BOOL),
+	KNXPROTO_DPT_LIB(2,  0, KNX_DPT_CVALUE),
+	KNXPROTO_DPT_LIB(3,  0, KNX_DPT_CSTEP),
+	KNXPROTO_DPT_LIB(4,  0, KNX_DPT_CHAR),
+	KNXPROTO_DPT_FORMAT(5, 1, DptRatio<100>),
+	KNXPROTO_DPT_FORMAT(5, 3, DptRatio<360>),
+	KNXPROTO_DPT_LIB(5,  0, KNX_DPT_UNSIGNED8),
+	KNXPROTO_DPT_LIB(6,  0, KNX_DPT_SIGNED8),
+	KNXPROTO_DPT_LIB(7,  0, KNX_DPT_UNSIGNED16),
+	KNXPROTO_DPT_LIB(8,  0, KNX_DPT_SIGNED16),
+	KNXPROTO_DPT_LIB(9,  0, KNX_DPT_FLOAT16),
+	KNXPROTO_DPT_LIB(10, 0, KNX_DPT_TIMEOFDAY),
+	KNXPROTO_DPT_LIB(11, 0, KNX_DPT_DATE),
+	KNXPROTO_DPT_LIB(12, 0, KNX_DPT_UNSIGNED32),
+	KNXPROTO_DPT_LIB(13, 0, KNX_DPT_SIGNED32),
+	KNXPROTO_DPT_LIB(14, 0, KNX_DPT_FLOAT32),
+	KNXPROTO_DPT_FORMAT(16,  0,   DptString),
+	KNXPROTO_DPT_FORMAT(19,  1,   DptDateTime),
+	KNXPROTO_DPT_FORMAT(232, 600, DptRGB)
+};
+
+static constexpr
+size_t dpt_entry_count = sizeof(dpt_entries) / sizeof(DptEntry);
+
+// Jump table from main number to the range of entries sharing it
+struct DptIndex {
+	uint8_t first[256];
+	uint8_t count[256];
+};
+
+static constexpr
+DptIndex dpt_build_index() {
+	DptIndex index {};
+
+	for (size_t i = 0; i < dpt_entry_count; i++) {
+		uint16_t main = dpt_entries[i].main;
+
+		if (index.count[main] == 0)
+			index.first[main] = i;
+
+		index.count[main]++;
+	}
+
+	return index;
+}
+
+static constexpr
+DptIndex dpt_index = dpt_build_index();
+
+// Entry for each libknxproto type, offset by one so that zero means none
+struct DptTypeIndex {
+	uint8_t entry[256];
+};
+
+static constexpr
+DptTypeIndex dpt_build_type_index() {
+	DptTypeIndex index {};
+
+	for (size_t i = 0; i < dpt_entry_count; i++)
+		if (dpt_entries[i].type >= 0 && dpt_entries[i].type < 256)
+			index.entry[dpt_entries[i].type] = i + 1;
+
+	return index;
+}
+
+static constexpr
+DptTypeIndex dpt_type_index = dpt_build_type_index();
+
+static inline
+const DptEntry* dpt_find(uint32_t id) {
+	uint32_t main = id >> 16;
+	uint32_t sub = id & 0xFFFF;
+
+	if (main > 255)
+		return nullptr;
+
+	const DptEntry* entry = dpt_entries + dpt_index.first[main];
+	const DptEntry* end = entry + dpt_index.count[main];
+
+	for (; entry != end; entry++)
+		if (entry->sub == sub || entry->sub == 0)
+			return entry;
+
+	return nullptr;
+}
+
+Handle<Value> knxproto_unpack_dpt(uint32_t id, Buffer payload) {
+	const DptEntry* entry = dpt_find(id);
+
+	if (!entry)
+		return Null(Isolate::GetCurrent());
+
+	return entry->unpack((const uint8_t*) payload.data, payload.length);
+}
+
+Handle<Value> knxproto_pack_dpt(uint32_t id, Local<Value> value) {
+	const DptEntry* entry = dpt_find(id);
+
+	if (!entry)
+		return Null(Isolate::GetCurrent());
+
+	return entry->pack(value);
+}
+
+uint32_t knxproto_pack_dpt_into(uint32_t id, Buffer buffer, uint32_t offset, Local<Value> value) {
+	const DptEntry* entry = dpt_find(id);
+
+	if (!entry || !buffer.data || offset > buffer.length)
+		return 0;
+
+	return entry->write(value, (uint8_t*) buffer.data + offset, buffer.length - offset);
+}
+
+// 'DptRegistry' keeps entries in a byte
+static_assert(dpt_entry_count < 255, "Too many DPT entries");
+
+int knxproto_dpt_entry(uint32_t dpt) {
+	if (dpt < 0x10000)
+		return dpt < 256 ? int(dpt_type_index.entry[dpt]) - 1 : -1;
+
+	const DptEntry* entry = dpt_find(dpt);
+	return entry ? int(entry - dpt_entries) : -1;
+}
+
+Handle<Value> knxproto_unpack_dpt_entry(int entry, const uint8_t* payload, size_t length) {
+	if (entry < 0 || size_t(entry) >= dpt_entry_count)
+		return Null(Isolate::GetCurrent());
+
+	return dpt_entries[entry].unpack(payload, length);
+}
+
+Handle<Value> knxproto_make_dpt_entry(int entry, size_t length, const void* value) {
+	if (entry < 0 || size_t(entry) >= dpt_entry_count || !dpt_entries[entry].encode)
+		return Null(Isolate::GetCurrent());
+
+	char* buffer = knxproto_pool_alloc(length);
+
+	if (dpt_entries[entry].encode(value, (uint8_t*) buffer, length) == 0) {
+		knxproto_pool_release(buffer, length);
+		return Null(Isolate::GetCurrent());
+	}
+
+	return knxproto_make_buffer(buffer, length);
+}
+
+uint32_t knxproto_make_dpt_entry_into(int entry, Buffer buffer, uint32_t offset, const void* value) {
+	if (entry < 0 || size_t(entry) >= dpt_entry_count || !dpt_entries[entry].encode)
+		return 0;
+
+	if (!buffer.data || offset > buffer.length)
+		return 0;
+
+	return dpt_entries[entry].encode(value, (uint8_t*) buffer.data + offset, buffer.length - offset);
+}
@@ -0,0 +1,227 @@
+#ifndef KNXPROTO_LIB_DPT_H_
+#define KNXPROTO_LIB_DPT_H_
+
+#include "data.hpp"
+
+#include <cstdint>
+
+// DPT identifiers combine main and sub number, e.g. 9.001 becomes KNXPROTO_DPT_ID(9, 1)
+#define KNXPROTO_DPT_ID(main, sub) ((uint32_t(main) << 16) | uint32_t(sub))
+
+struct knxproto_string {
+	// ISO 8859-1, zero terminated unless all 14 characters are used
+	char data[14];
+};
+
+struct knxproto_datetime {
+	uint16_t year;
+	uint8_t month;
+	uint8_t day;
+	uint8_t day_of_week;
+	uint8_t hour;
+	uint8_t minute;
+	uint8_t second;
+
+	// Fault, working day and validity flags as they appear on the bus
+	uint16_t flags;
+};
+
+struct knxproto_rgb {
+	uint8_t red;
+	uint8_t green;
+	uint8_t blue;
+};
+
+namespace jawra {
+	template <>
+	struct ValueWrapper<knxproto_string> {
+		static
+		constexpr const char* TypeName = "KNX string";
+
+		static inline
+		bool check(v8::Handle<v8::Value> value) {
+			return value->IsString();
+		}
+
+		static inline
+		knxproto_string unpack(v8::Handle<v8::Value> value) {
+			knxproto_string result {};
+			value->ToString()->WriteOneByte((uint8_t*) result.data, 0, sizeof(result.data),
+			                                v8::String::NO_NULL_TERMINATION);
+
+			return result;
+		}
+
+		static inline
+		v8::Local<v8::String> pack(v8::Isolate* isolate, const knxproto_string& value) {
+			size_t length = 0;
+			while (length < sizeof(value.data) && value.data[length] != 0)
+				length++;
+
+			return v8::String::NewFromOneByte(isolate, (const uint8_t*) value.data, v8::String::kNormalString, length);
+		}
+	};
+
+	template <>
+	struct ValueWrapper<knxproto_datetime> {
+		static
+		constexpr const char* TypeName = "KNX date-time";
+
+		static inline
+		bool check(v8::Handle<v8::Value> value) {
+			if (!value->IsObject())
+				return false;
+
+			ObjectWrapper value_wrap(v8::Isolate::GetCurrent(), value->ToObject());
+
+			return
+				value_wrap.expect<uint32_t>("year") &&
+				value_wrap.expect<uint32_t>("month") &&
+				value_wrap.expect<uint32_t>("day") &&
+				value_wrap.expect<uint32_t>("hour") &&
+				value_wrap.expect<uint32_t>("minute") &&
+				value_wrap.expect<uint32_t>("second");
+		}
+
+		static inline
+		knxproto_datetime unpack(v8::Handle<v8::Value> value) {
+			ObjectWrapper value_wrap(v8::Isolate::GetCurrent(), value->ToObject());
+
+			return {
+				uint16_t(value_wrap.get<uint32_t>("year")),
+				uint8_t(value_wrap.get<uint32_t>("month")),
+				uint8_t(value_wrap.get<uint32_t>("day")),
+				uint8_t(value_wrap.check<uint32_t>("dayOfWeek") ? value_wrap.get<uint32_t>("dayOfWeek") : 0),
+				uint8_t(value_wrap.get<uint32_t>("hour")),
+				uint8_t(value_wrap.get<uint32_t>("minute")),
+				uint8_t(value_wrap.get<uint32_t>("second")),
+				uint16_t(value_wrap.check<uint32_t>("flags") ? value_wrap.get<uint32_t>("flags") : 0)
+			};
+		}
+
+		static inline
+		v8::Local<v8::Object> pack(v8::Isolate* isolate, const knxproto_datetime& value) {
+			ObjectWrapper value_wrap(isolate);
+
+			value_wrap.set("year",      uint32_t(value.year));
+			value_wrap.set("month",     uint32_t(value.month));
+			value_wrap.set("day",       uint32_t(value.day));
+			value_wrap.set("dayOfWeek", uint32_t(value.day_of_week));
+			value_wrap.set("hour",      uint32_t(value.hour));
+			value_wrap.set("minute",    uint32_t(value.minute));
+			value_wrap.set("second",    uint32_t(value.second));
+			value_wrap.set("flags",     uint32_t(value.flags));
+
+			return value_wrap;
+		}
+	};
+
+	template <>
+	struct ValueWrapper<knxproto_rgb> {
+		static
+		constexpr const char* TypeName = "KNX RGB";
+
+		static inline
+		bool check(v8::Handle<v8::Value> value) {
+			if (!value->IsObject())
+				return false;
+
+			ObjectWrapper value_wrap(v8::Isolate::GetCurrent(), value->ToObject());
+
+			return
+				value_wrap.expect<uint32_t>("red") &&
+				value_wrap.expect<uint32_t>("green") &&
+				value_wrap.expect<uint32_t>("blue");
+		}
+
+		static inline
+		knxproto_rgb unpack(v8::Handle<v8::Value> value) {
+			ObjectWrapper value_wrap(v8::Isolate::GetCurrent(), value->ToObject());
+
+			return {
+				uint8_t(value_wrap.get<uint32_t>("red")),
+				uint8_t(value_wrap.get<uint32_t>("green")),
+				uint8_t(value_wrap.get<uint32_t>("blue"))
+			};
+		}
+
+		static inline
+		v8::Local<v8::Object> pack(v8::Isolate* isolate, const knxproto_rgb& value) {
+			ObjectWrapper value_wrap(isolate);
+
+			value_wrap.set("red",   uint32_t(value.red));
+			value_wrap.set("green", uint32_t(value.green));
+			value_wrap.set("blue",  uint32_t(value.blue));
+
+			return value_wrap;
+		}
+	};
+}
+
+// Decode or encode any DPT known to the registry, yields null if the DPT is unknown or the
+// payload/value does not fit it
+v8::Handle<v8::Value> knxproto_unpack_dpt(uint32_t id, jawra::Buffer payload);
+
+v8::Handle<v8::Value> knxproto_pack_dpt(uint32_t id, v8::Local<v8::Value> value);
+
+// Encode into 'buffer' at 'offset', yields the number of bytes written or zero on failure
+uint32_t knxproto_pack_dpt_into(uint32_t id, jawra::Buffer buffer, uint32_t offset, v8::Local<v8::Value> value);
+
+// Index of the registry entry for 'dpt', which is either a DPT id or, below 0x10000, a libknxproto
+// type. Negative if there is none.
+int knxproto_dpt_entry(uint32_t dpt);
+
+// Decode 'payload' with the registry entry at 'entry', yields null if that is not possible
+v8::Handle<v8::Value> knxproto_unpack_dpt_entry(int entry, const uint8_t* payload, size_t length);
+
+// Encode the value at 'value' with the registry entry at 'entry', which must be backed by
+// libknxproto and represent values like 'knxproto_dpt_type' does
+v8::Handle<v8::Value> knxproto_make_dpt_entry(int entry, size_t length, const void* value);
+
+uint32_t knxproto_make_dpt_entry_into(int entry, jawra::Buffer buffer, uint32_t offset, const void* value);
+
+// libknxproto value type and JavaScript representation of each libknxproto type, the codec table
+// builds its rows for them from this
+template <knx_dpt C>
+struct knxproto_dpt_type;
+
+#define KNXPROTO_DPT_TYPE(c, t, r) \
+	template <> \
+	struct knxproto_dpt_type<c> { \
+		using type = t; \
+		using repr = r; \
+	};
+
+KNXPROTO_DPT_TYPE(KNX_DPT_BOOL,       knx_bool,       bool)
+KNXPROTO_DPT_TYPE(KNX_DPT_CVALUE,     knx_cvalue,     knx_cvalue)
+KNXPROTO_DPT_TYPE(KNX_DPT_CSTEP,      knx_cstep,      knx_cstep)
+KNXPROTO_DPT_TYPE(KNX_DPT_CHAR,       knx_char,       char)
+KNXPROTO_DPT_TYPE(KNX_DPT_UNSIGNED8,  knx_unsigned8,  uint32_t)
+KNXPROTO_DPT_TYPE(KNX_DPT_SIGNED8,    knx_signed8,    int32_t)
+KNXPROTO_DPT_TYPE(KNX_DPT_UNSIGNED16, knx_unsigned16, uint32_t)
+KNXPROTO_DPT_TYPE(KNX_DPT_SIGNED16,   knx_signed16,   int32_t)
+KNXPROTO_DPT_TYPE(KNX_DPT_FLOAT16,    knx_float16,    double)
+KNXPROTO_DPT_TYPE(KNX_DPT_TIMEOFDAY,  knx_timeofday,  knx_timeofday)
+KNXPROTO_DPT_TYPE(KNX_DPT_DATE,       knx_date,       knx_date)
+KNXPROTO_DPT_TYPE(KNX_DPT_UNSIGNED32, knx_unsigned32, uint32_t)
+KNXPROTO_DPT_TYPE(KNX_DPT_SIGNED32,   knx_signed32,   int32_t)
+KNXPROTO_DPT_TYPE(KNX_DPT_FLOAT32,    knx_float32,    double)
+
+// Per-type entry points, they go through the codec table row of libknxproto type 'C'
+template <knx_dpt C>
+v8::Handle<v8::Value> knxproto_parse_type(jawra::Buffer payload) {
+	return knxproto_unpack_dpt_entry(knxproto_dpt_entry(C), (const uint8_t*) payload.data, payload.length);
+}
+
+template <knx_dpt C>
+v8::Handle<v8::Value> knxproto_make_type(typename knxproto_dpt_type<C>::repr value) {
+	return knxproto_make_dpt_entry(knxproto_dpt_entry(C), knx_dpt_size(C), &value);
+}
+
+// Encode into 'buffer' at 'offset', yields the number of bytes written or zero if they don't fit
+template <knx_dpt C>
+uint32_t knxproto_make_type_into(jawra::Buffer buffer, uint32_t offset, typename knxproto_dpt_type<C>::repr value) {
+	return knxproto_make_dpt_entry_into(knxproto_dpt_entry(C), buffer, offset, &value);
+}
+
+#endif
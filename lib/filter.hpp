@@ -0,0 +1,45 @@
+#ifndef KNXPROTO_LIB_FILTER_H_
+#define KNXPROTO_LIB_FILTER_H_
+
+extern "C" {
+	#include <knxproto/proto/cemi.h>
+}
+
+#include <cstdint>
+
+// Set of subscribed group addresses, one bit per address
+struct GroupFilter {
+	uint64_t words[65536 / 64];
+	uint64_t filtered;
+
+	inline
+	void subscribe(knx_addr addr) {
+		words[addr >> 6] |= uint64_t(1) << (addr & 63);
+	}
+
+	inline
+	void unsubscribe(knx_addr addr) {
+		words[addr >> 6] &= ~(uint64_t(1) << (addr & 63));
+	}
+
+	inline
+	bool contains(knx_addr addr) const {
+		return (words[addr >> 6] >> (addr & 63)) & 1;
+	}
+
+	// Frames addressed to individual devices and confirmations of our own requests are always
+	// accepted
+	inline
+	bool accept(const knx_cemi& frame) {
+		const knx_ldata& ldata = frame.payload.ldata;
+
+		if (frame.service == KNX_CEMI_LDATA_CON ||
+		    ldata.control2.address_type != KNX_LDATA_ADDR_GROUP || contains(ldata.destination))
+			return true;
+
+		filtered++;
+		return false;
+	}
+};
+
+#endif
@@ -1,9 +1,26 @@
+#include "bulk.hpp"
+#include "cache.hpp"
+#include "capture.hpp"
+#include "columns.hpp"
 #include "data.hpp"
+#include "delivery.hpp"
+#include "dpt.hpp"
+#include "filter.hpp"
+#include "pool.hpp"
+#include "queue.hpp"
+#include "registry.hpp"
+#include "scheduler.hpp"
+#include "stats.hpp"
+#include "transport.hpp"
+#include "worker.hpp"
 
 #include <node.h>
+#include <node_buffer.h>
 #include <jawra.hpp>
 
 #include <algorithm>
+#include <initializer_list>
+#include <string>
 
 extern "C" {
 	#include <knxproto/router.h>
@@ -15,12 +32,449 @@ using namespace jawra;
 
 static
 Handle<Value> copy_buffer(const char* buffer_origin, size_t size) {
-	char* buffer = new char[size];
+	char* buffer = knxproto_pool_alloc(size);
 	std::copy(buffer_origin, buffer_origin + size, buffer);
 
 	return knxproto_make_buffer(buffer, size);
 }
 
+// Datagram which is being decoded while its wrapper is in zero-copy mode
+struct DatagramView {
+	Local<Object> buffer;
+	const uint8_t* data;
+	size_t length;
+
+	// Start of the cEMI frame, equals 'length' if there is none
+	size_t cemi_offset;
+};
+
+// Frames and events gathered by 'process_batch', which owns the instance on its stack
+struct FrameBatch {
+	Local<Array> frames;
+	uint32_t length;
+
+	inline
+	void append(Isolate* isolate, Local<Value> value) {
+		frames->Set(isolate->GetCurrentContext(), length++, value).FromMaybe(false);
+	}
+};
+
+// Datagram of the wrapper whose frame is being packed, only set during 'pack_frame'
+static thread_local
+const DatagramView* current_view = nullptr;
+
+static
+Handle<Value> make_view(const DatagramView* view, size_t offset, size_t length) {
+	Local<Uint8Array> source = view->buffer.As<Uint8Array>();
+	Local<Object> buffer;
+
+	if (!node::Buffer::New(Isolate::GetCurrent(), source->Buffer(), source->ByteOffset() + offset, length).ToLocal(&buffer))
+		return copy_buffer((const char*) view->data + offset, length);
+
+	return buffer;
+}
+
+// Payloads located inside the current datagram are emitted as views onto it, others are copied
+static
+Handle<Value> make_payload(const uint8_t* payload, size_t length) {
+	if (current_view && payload >= current_view->data &&
+	    payload + length <= current_view->data + current_view->length)
+		return make_view(current_view, payload - current_view->data, length);
+
+	return copy_buffer((const char*) payload, length);
+}
+
+// Interned property keys and object templates for received frames. Each frame object is
+// instantiated from a template which already declares all of its properties, therefore frames of
+// the same kind share one hidden class and packing them creates no key strings.
+struct FrameShapes {
+	Persistent<String> tpci, sequence_number, apci, payload, control;
+	Persistent<String> priority, repeat, system_broadcast, request_ack, error, address_type, hops;
+	Persistent<String> source, destination, tpdu, service, raw, value;
+
+	Persistent<ObjectTemplate> unnumbered_data, numbered_data, unnumbered_control, numbered_control;
+	Persistent<ObjectTemplate> unnumbered_data_value, numbered_data_value;
+	Persistent<ObjectTemplate> unnumbered_value_only, numbered_value_only;
+	Persistent<ObjectTemplate> ldata;
+	Persistent<ObjectTemplate> cemi, cemi_raw;
+};
+
+// Interned keys and templates of the statistics objects, which are meant to be read often
+struct StatsShapes {
+	Persistent<String> datagrams_in, datagrams_out, bytes_in, bytes_out, frames_decoded;
+	Persistent<String> decode_failures, resends, queue_depth, callbacks, callback_time, ack_latency;
+	Persistent<String> abandoned, retransmit_timeout, dropped;
+	Persistent<String> count, min, max, mean, p50, p90, p99, p999;
+
+	Persistent<ObjectTemplate> router, tunnel, latency;
+};
+
+// State of the addon within one isolate. Node gives every isolate, the main one as well as those
+// of worker threads, a thread of its own, hence the state is kept per thread.
+struct AddonState {
+	Isolate* isolate;
+	uv_loop_t* loop;
+
+	FrameShapes shapes;
+	StatsShapes stats;
+};
+
+static thread_local
+AddonState* addon_state = nullptr;
+
+static
+void shape_key(Isolate* isolate, Persistent<String>& target, const char* name) {
+	target.Reset(isolate, String::NewFromUtf8(isolate, name, String::kInternalizedString));
+}
+
+static
+void shape_template(
+	Isolate*                                          isolate,
+	Persistent<ObjectTemplate>&                       target,
+	std::initializer_list<const Persistent<String>*> keys
+) {
+	Local<ObjectTemplate> tmpl = ObjectTemplate::New(isolate);
+
+	for (const Persistent<String>* key: keys)
+		tmpl->Set(Local<String>::New(isolate, *key), Undefined(isolate));
+
+	target.Reset(isolate, tmpl);
+}
+
+static
+void frame_shapes_init(Isolate* isolate, FrameShapes& fs) {
+	auto key = [isolate](Persistent<String>& target, const char* name) {
+		shape_key(isolate, target, name);
+	};
+
+	key(fs.tpci,             "tpci");
+	key(fs.sequence_number,  "sequenceNumber");
+	key(fs.apci,             "apci");
+	key(fs.payload,          "payload");
+	key(fs.control,          "control");
+	key(fs.priority,         "priority");
+	key(fs.repeat,           "repeat");
+	key(fs.system_broadcast, "systemBroadcast");
+	key(fs.request_ack,      "requestAck");
+	key(fs.error,            "error");
+	key(fs.address_type,     "addressType");
+	key(fs.hops,             "hops");
+	key(fs.source,           "source");
+	key(fs.destination,      "destination");
+	key(fs.tpdu,             "tpdu");
+	key(fs.service,          "service");
+	key(fs.raw,              "raw");
+	key(fs.value,            "value");
+
+	auto shape = [isolate](Persistent<ObjectTemplate>& target,
+	                       std::initializer_list<const Persistent<String>*> keys) {
+		shape_template(isolate, target, keys);
+	};
+
+	shape(fs.unnumbered_data,    {&fs.tpci, &fs.apci, &fs.payload});
+	shape(fs.numbered_data,      {&fs.tpci, &fs.sequence_number, &fs.apci, &fs.payload});
+	shape(fs.unnumbered_control, {&fs.tpci, &fs.control});
+	shape(fs.numbered_control,   {&fs.tpci, &fs.sequence_number, &fs.control});
+
+	shape(fs.unnumbered_data_value, {&fs.tpci, &fs.apci, &fs.payload, &fs.value});
+	shape(fs.numbered_data_value,   {&fs.tpci, &fs.sequence_number, &fs.apci, &fs.payload, &fs.value});
+	shape(fs.unnumbered_value_only, {&fs.tpci, &fs.apci, &fs.value});
+	shape(fs.numbered_value_only,   {&fs.tpci, &fs.sequence_number, &fs.apci, &fs.value});
+
+	shape(fs.ldata, {
+		&fs.priority, &fs.repeat, &fs.system_broadcast, &fs.request_ack, &fs.error,
+		&fs.address_type, &fs.hops, &fs.source, &fs.destination, &fs.tpdu
+	});
+
+	shape(fs.cemi,     {&fs.service, &fs.payload});
+	shape(fs.cemi_raw, {&fs.service, &fs.payload, &fs.raw});
+}
+
+static
+void stats_shapes_init(Isolate* isolate, StatsShapes& ss) {
+	shape_key(isolate, ss.datagrams_in,       "datagramsIn");
+	shape_key(isolate, ss.datagrams_out,      "datagramsOut");
+	shape_key(isolate, ss.bytes_in,           "bytesIn");
+	shape_key(isolate, ss.bytes_out,          "bytesOut");
+	shape_key(isolate, ss.frames_decoded,     "framesDecoded");
+	shape_key(isolate, ss.decode_failures,    "decodeFailures");
+	shape_key(isolate, ss.resends,            "resends");
+	shape_key(isolate, ss.queue_depth,        "queueDepth");
+	shape_key(isolate, ss.callbacks,          "callbacks");
+	shape_key(isolate, ss.callback_time,      "callbackTime");
+	shape_key(isolate, ss.ack_latency,        "ackLatency");
+	shape_key(isolate, ss.abandoned,          "abandoned");
+	shape_key(isolate, ss.retransmit_timeout, "retransmitTimeout");
+	shape_key(isolate, ss.dropped,            "dropped");
+	shape_key(isolate, ss.count,              "count");
+	shape_key(isolate, ss.min,                "min");
+	shape_key(isolate, ss.max,                "max");
+	shape_key(isolate, ss.mean,               "mean");
+	shape_key(isolate, ss.p50,                "p50");
+	shape_key(isolate, ss.p90,                "p90");
+	shape_key(isolate, ss.p99,                "p99");
+	shape_key(isolate, ss.p999,               "p999");
+
+	shape_template(isolate, ss.router, {
+		&ss.datagrams_in, &ss.datagrams_out, &ss.bytes_in, &ss.bytes_out, &ss.frames_decoded,
+		&ss.decode_failures, &ss.resends, &ss.queue_depth, &ss.callbacks, &ss.callback_time
+	});
+
+	shape_template(isolate, ss.tunnel, {
+		&ss.datagrams_in, &ss.datagrams_out, &ss.bytes_in, &ss.bytes_out, &ss.frames_decoded,
+		&ss.decode_failures, &ss.resends, &ss.queue_depth, &ss.callbacks, &ss.callback_time,
+		&ss.ack_latency, &ss.abandoned, &ss.retransmit_timeout, &ss.dropped
+	});
+
+	shape_template(isolate, ss.latency, {
+		&ss.count, &ss.min, &ss.max, &ss.mean, &ss.p50, &ss.p90, &ss.p99, &ss.p999
+	});
+}
+
+static inline
+const Persistent<ObjectTemplate>& frame_tpdu_shape(knx_tpci tpci, bool with_value, bool with_payload) {
+	const FrameShapes& fs = addon_state->shapes;
+
+	switch (tpci) {
+		case KNX_TPCI_NUMBERED_DATA:
+			if (!with_value) return fs.numbered_data;
+			return with_payload ? fs.numbered_data_value : fs.numbered_value_only;
+
+		case KNX_TPCI_NUMBERED_CONTROL:
+			return addon_state->shapes.numbered_control;
+
+		case KNX_TPCI_UNNUMBERED_CONTROL:
+			return addon_state->shapes.unnumbered_control;
+
+		default:
+			if (!with_value) return fs.unnumbered_data;
+			return with_payload ? fs.unnumbered_data_value : fs.unnumbered_value_only;
+	}
+}
+
+static inline
+Local<Object> frame_instantiate(Isolate* isolate, const Persistent<ObjectTemplate>& shape) {
+	return Local<ObjectTemplate>::New(isolate, shape)->NewInstance();
+}
+
+static inline
+void frame_set(Isolate* isolate, Local<Object> object, const Persistent<String>& key, Local<Value> value) {
+	object->Set(Local<String>::New(isolate, key), value);
+}
+
+static inline
+void frame_set(Isolate* isolate, Local<Object> object, const Persistent<String>& key, uint32_t value) {
+	frame_set(isolate, object, key, Integer::NewFromUnsigned(isolate, value));
+}
+
+static inline
+void frame_set(Isolate* isolate, Local<Object> object, const Persistent<String>& key, bool value) {
+	frame_set(isolate, object, key, Boolean::New(isolate, value));
+}
+
+static inline
+void frame_set(Isolate* isolate, Local<Object> object, const Persistent<String>& key, double value) {
+	frame_set(isolate, object, key, Number::New(isolate, value));
+}
+
+static inline
+Local<Value> frame_get(Isolate* isolate, Local<Object> object, const Persistent<String>& key) {
+	return object->Get(Local<String>::New(isolate, key));
+}
+
+static inline
+bool frame_get(Isolate* isolate, Local<Object> object, const Persistent<String>& key, uint32_t& target) {
+	Local<Value> value = frame_get(isolate, object, key);
+	if (!value->IsUint32()) return false;
+
+	target = value->Uint32Value();
+	return true;
+}
+
+static inline
+bool frame_get(Isolate* isolate, Local<Object> object, const Persistent<String>& key, bool& target) {
+	Local<Value> value = frame_get(isolate, object, key);
+	if (!value->IsBoolean()) return false;
+
+	target = value->BooleanValue();
+	return true;
+}
+
+// The unmarshallers below validate a frame object and read it in the same pass, looking up every
+// property exactly once through the interned keys. On failure 'error' names the offending property
+// by its path within a cEMI frame.
+
+static
+bool unmarshal_tpdu(Isolate* isolate, Local<Value> value, knx_tpdu& tpdu, const char*& error) {
+	const FrameShapes& fs = addon_state->shapes;
+
+	if (!value->IsObject()) {
+		error = "payload.tpdu";
+		return false;
+	}
+
+	Local<Object> object = value.As<Object>();
+	uint32_t tpci, seq_number, apci, control;
+
+	if (!frame_get(isolate, object, fs.tpci, tpci)) {
+		error = "payload.tpdu.tpci";
+		return false;
+	}
+
+	tpdu.tpci = (knx_tpci) tpci;
+	tpdu.seq_number = 0;
+
+	switch (tpdu.tpci) {
+		case KNX_TPCI_NUMBERED_DATA:
+			if (!frame_get(isolate, object, fs.sequence_number, seq_number)) {
+				error = "payload.tpdu.sequenceNumber";
+				return false;
+			}
+
+			tpdu.seq_number = seq_number;
+
+		case KNX_TPCI_UNNUMBERED_DATA: {
+			if (!frame_get(isolate, object, fs.apci, apci)) {
+				error = "payload.tpdu.apci";
+				return false;
+			}
+
+			Local<Value> payload = frame_get(isolate, object, fs.payload);
+
+			if (!node::Buffer::HasInstance(payload)) {
+				error = "payload.tpdu.payload";
+				return false;
+			}
+
+			tpdu.info.data.apci = (knx_apci) apci;
+			tpdu.info.data.payload = (const uint8_t*) node::Buffer::Data(payload);
+			tpdu.info.data.length = node::Buffer::Length(payload);
+
+			return true;
+		}
+
+		case KNX_TPCI_NUMBERED_CONTROL:
+			if (!frame_get(isolate, object, fs.sequence_number, seq_number)) {
+				error = "payload.tpdu.sequenceNumber";
+				return false;
+			}
+
+			tpdu.seq_number = seq_number;
+
+		case KNX_TPCI_UNNUMBERED_CONTROL:
+			if (!frame_get(isolate, object, fs.control, control)) {
+				error = "payload.tpdu.control";
+				return false;
+			}
+
+			tpdu.info.control = (knx_tpci_control) control;
+
+			return true;
+
+		default:
+			error = "payload.tpdu.tpci";
+			return false;
+	}
+}
+
+// Optional properties which are missing or of the wrong type take their default
+static
+bool unmarshal_ldata(Isolate* isolate, Local<Value> value, knx_ldata& ldata, const char*& error) {
+	const FrameShapes& fs = addon_state->shapes;
+
+	if (!value->IsObject()) {
+		error = "payload";
+		return false;
+	}
+
+	Local<Object> object = value.As<Object>();
+	uint32_t number;
+	bool flag;
+
+	if (!frame_get(isolate, object, fs.destination, number)) {
+		error = "payload.destination";
+		return false;
+	}
+
+	ldata.destination = (knx_addr) number;
+
+	// Control 1
+	ldata.control1.priority = frame_get(isolate, object, fs.priority, number)
+	                        ? (knx_ldata_prio) number
+	                        : KNX_LDATA_PRIO_LOW;
+
+	ldata.control1.repeat           = frame_get(isolate, object, fs.repeat, flag)           ? flag : true;
+	ldata.control1.system_broadcast = frame_get(isolate, object, fs.system_broadcast, flag) ? flag : true;
+	ldata.control1.request_ack      = frame_get(isolate, object, fs.request_ack, flag)      ? flag : true;
+	ldata.control1.error            = frame_get(isolate, object, fs.error, flag)            ? flag : false;
+
+	// Control 2
+	ldata.control2.address_type = frame_get(isolate, object, fs.address_type, number)
+	                            ? (knx_ldata_addr_type) number
+	                            : KNX_LDATA_ADDR_GROUP;
+
+	ldata.control2.hops = frame_get(isolate, object, fs.hops, number) ? number : 7;
+
+	// Addresses
+	ldata.source = frame_get(isolate, object, fs.source, number) ? (knx_addr) number : 0;
+
+	// Read last, so that no getter can run once the payload pointer has been taken
+	return unmarshal_tpdu(isolate, frame_get(isolate, object, fs.tpdu), ldata.tpdu, error);
+}
+
+static
+bool unmarshal_cemi(Isolate* isolate, Local<Value> value, knx_cemi& cemi, const char*& error) {
+	const FrameShapes& fs = addon_state->shapes;
+
+	if (!value->IsObject()) {
+		error = "frame";
+		return false;
+	}
+
+	Local<Object> object = value.As<Object>();
+	uint32_t service;
+
+	if (!frame_get(isolate, object, fs.service, service)) {
+		error = "service";
+		return false;
+	}
+
+	cemi = knx_cemi {(knx_cemi_service) service, 0, nullptr};
+
+	return unmarshal_ldata(isolate, frame_get(isolate, object, fs.payload), cemi.payload.ldata, error);
+}
+
+// Read a frame passed to one of the send functions. Throws a TypeError naming the offending
+// property if it can not be sent. The payload points into the frame's Buffer, which only stays
+// valid while the frame is reachable.
+static
+bool unmarshal_argument(Local<Value> frame, knx_cemi& cemi) {
+	Isolate* isolate = Isolate::GetCurrent();
+	const char* error;
+
+	if (unmarshal_cemi(isolate, frame, cemi, error))
+		return true;
+
+	std::string message = std::string("Invalid frame property: ") + error;
+	isolate->ThrowException(Exception::TypeError(String::NewFromUtf8(isolate, message.c_str())));
+
+	return false;
+}
+
+// Null if 'frame' could be sent, otherwise the path of the offending property
+static
+Handle<Value> knxproto_frame_error(Local<Value> frame) {
+	Isolate* isolate = Isolate::GetCurrent();
+
+	knx_cemi cemi;
+	const char* error = nullptr;
+
+	if (unmarshal_cemi(isolate, frame, cemi, error))
+		return Null(isolate);
+
+	return String::NewFromUtf8(isolate, error);
+}
+
 namespace jawra {
 	template <>
 	struct ValueWrapper<knx_tpdu> {
@@ -29,349 +483,1914 @@ namespace jawra {
 
 		static inline
 		bool check(v8::Local<v8::Value> value) {
-			if (!ValueWrapper<ObjectWrapper>::check(value))
-				return false;
+			knx_tpdu tpdu;
+			const char* error;
 
-			ObjectWrapper wrapper = ValueWrapper<ObjectWrapper>::unpack(value);
+			return unmarshal_tpdu(Isolate::GetCurrent(), value, tpdu, error);
+		}
 
-			if (!wrapper.expect<uint32_t>("tpci"))
-				return false;
+		static inline
+		knx_tpdu unpack(v8::Local<v8::Value> value) {
+			knx_tpdu tpdu {};
+			const char* error;
 
-			knx_tpci tpci = (knx_tpci) wrapper.get<uint32_t>("tpci");
-			switch (tpci) {
+			unmarshal_tpdu(Isolate::GetCurrent(), value, tpdu, error);
+			return tpdu;
+		}
+
+		// With a DPT registry entry, see 'knxproto_dpt_entry', the payload is also decoded into 'value'.
+		// 'with_payload' decides whether the raw payload is kept next to it.
+		static inline
+		v8::Local<v8::Object> pack(v8::Isolate* isolate, const knx_tpdu& value, int dpt_entry = -1,
+		                           bool with_payload = true) {
+			const FrameShapes& fs = addon_state->shapes;
+			bool with_value = dpt_entry >= 0;
+			Local<Object> object = frame_instantiate(isolate, frame_tpdu_shape(value.tpci, with_value, with_payload));
+
+			frame_set(isolate, object, fs.tpci, (uint32_t) value.tpci);
+
+			switch (value.tpci) {
 				case KNX_TPCI_NUMBERED_DATA:
-					if (!wrapper.expect<uint32_t>("sequenceNumber"))
-						return false;
+					frame_set(isolate, object, fs.sequence_number, (uint32_t) value.seq_number);
 
 				case KNX_TPCI_UNNUMBERED_DATA:
-					return wrapper.expect<uint32_t>("apci") && wrapper.expect<Buffer>("payload");
+					frame_set(isolate, object, fs.apci, (uint32_t) value.info.data.apci);
 
-				case KNX_TPCI_UNNUMBERED_CONTROL:
-					if (!wrapper.expect<uint32_t>("sequenceNumber"))
-						return false;
+					if (!with_value || with_payload)
+						frame_set(isolate, object, fs.payload, make_payload(value.info.data.payload, value.info.data.length));
+
+					if (with_value)
+						frame_set(isolate, object, fs.value, knxproto_unpack_dpt_entry(dpt_entry, value.info.data.payload,
+						                                                               value.info.data.length));
+
+					break;
 
 				case KNX_TPCI_NUMBERED_CONTROL:
-					return wrapper.expect<uint32_t>("control");
+					frame_set(isolate, object, fs.sequence_number, (uint32_t) value.seq_number);
+
+				case KNX_TPCI_UNNUMBERED_CONTROL:
+					frame_set(isolate, object, fs.control, (uint32_t) value.info.control);
+
+					break;
 			}
+
+			return object;
 		}
+	};
+
+	template <>
+	struct ValueWrapper<knx_ldata> {
+		static
+		constexpr const char* TypeName = "L_Data";
 
 		static inline
-		knx_tpdu unpack(v8::Local<v8::Value> value) {
-			ObjectWrapper wrapper = ValueWrapper<ObjectWrapper>::unpack(value);
-			knx_tpdu tpdu;
+		bool check(v8::Local<v8::Value> value) {
+			knx_ldata ldata;
+			const char* error;
 
-			tpdu.tpci = (knx_tpci) wrapper.get<uint32_t>("tpci");
-			tpdu.seq_number = 0;
+			return unmarshal_ldata(Isolate::GetCurrent(), value, ldata, error);
+		}
 
-			switch (tpdu.tpci) {
-				case KNX_TPCI_NUMBERED_DATA:
-					tpdu.seq_number = wrapper.get<uint32_t>("sequenceNumber");
+		static inline
+		knx_ldata unpack(v8::Local<v8::Value> value) {
+			knx_ldata ldata {};
+			const char* error;
+
+			unmarshal_ldata(Isolate::GetCurrent(), value, ldata, error);
+			return ldata;
+		}
 
-				case KNX_TPCI_UNNUMBERED_DATA: {
-					Buffer payload = wrapper.get<Buffer>("payload");
+		static inline
+		v8::Local<v8::Object> pack(v8::Isolate* isolate, const knx_ldata& value, const DptRegistry* dpts = nullptr) {
+			const FrameShapes& fs = addon_state->shapes;
+			Local<Object> object = frame_instantiate(isolate, fs.ldata);
 
-					tpdu.info.data.apci = (knx_apci) wrapper.get<uint32_t>("apci");
-					tpdu.info.data.payload = (const uint8_t*) payload.data;
-					tpdu.info.data.length = payload.length;
+			frame_set(isolate, object, fs.priority,         (uint32_t) value.control1.priority);
+			frame_set(isolate, object, fs.repeat,                      value.control1.repeat);
+			frame_set(isolate, object, fs.system_broadcast,            value.control1.system_broadcast);
+			frame_set(isolate, object, fs.request_ack,                 value.control1.request_ack);
+			frame_set(isolate, object, fs.error,                       value.control1.error);
+			frame_set(isolate, object, fs.address_type,     (uint32_t) value.control2.address_type);
+			frame_set(isolate, object, fs.hops,             (uint32_t) value.control2.hops);
 
-					break;
-				}
+			frame_set(isolate, object, fs.source,           (uint32_t) value.source);
+			frame_set(isolate, object, fs.destination,      (uint32_t) value.destination);
 
-				case KNX_TPCI_NUMBERED_CONTROL:
-					tpdu.seq_number = wrapper.get<uint32_t>("sequenceNumber");
+			int dpt_entry = -1;
+			bool has_dpt = dpts && dpts->find(value, dpt_entry);
+
+			Local<Value> tpdu = ValueWrapper<knx_tpdu>::pack(isolate, value.tpdu, dpt_entry,
+			                                                 !has_dpt || dpts->keeps_payload(value.destination));
+			frame_set(isolate, object, fs.tpdu, tpdu);
+
+			return object;
+		}
+	};
+
+	template <>
+	struct ValueWrapper<knx_cemi> {
+		static
+		constexpr const char* TypeName = "CEMI";
+
+		static inline
+		bool check(v8::Local<v8::Value> value) {
+			knx_cemi cemi;
+			const char* error;
+
+			return unmarshal_cemi(Isolate::GetCurrent(), value, cemi, error);
+		}
+
+		static inline
+		knx_cemi unpack(v8::Local<v8::Value> value) {
+			knx_cemi cemi {};
+			const char* error;
+
+			unmarshal_cemi(Isolate::GetCurrent(), value, cemi, error);
+			return cemi;
+		}
+
+		static inline
+		v8::Local<v8::Object> pack(v8::Isolate* isolate, const knx_cemi& value, const DptRegistry* dpts = nullptr) {
+			const FrameShapes& fs = addon_state->shapes;
+			bool has_raw = current_view && current_view->cemi_offset < current_view->length;
+
+			Local<Object> object = frame_instantiate(isolate, has_raw ? fs.cemi_raw : fs.cemi);
+
+			Local<Value> payload = ValueWrapper<knx_ldata>::pack(isolate, value.payload.ldata, dpts);
+			frame_set(isolate, object, fs.service, (uint32_t) value.service);
+			frame_set(isolate, object, fs.payload, payload);
+
+			if (has_raw)
+				frame_set(isolate, object, fs.raw, make_view(current_view, current_view->cemi_offset,
+				                                             current_view->length - current_view->cemi_offset));
+
+			return object;
+		}
+	};
+}
+
+// Decode a datagram given as a Buffer, unless the wrapper has been disposed. Wrappers in zero-copy
+// mode expose the datagram while doing so, in order for payloads to be packed as views onto it.
+template <typename W>
+static
+bool process_datagram(W* wrapper, Local<Value> message) {
+	if (wrapper->disposed || !node::Buffer::HasInstance(message))
+		return false;
+
+	const uint8_t* data = (const uint8_t*) node::Buffer::Data(message);
+	size_t length = node::Buffer::Length(message);
+
+	if (!wrapper->zero_copy)
+		return W::process_raw(wrapper, data, length);
+
+	DatagramView view {message.As<Object>(), data, length, W::cemi_offset(data, length)};
+
+	const DatagramView* previous_view = wrapper->view;
+	wrapper->view = &view;
+
+	bool result = W::process_raw(wrapper, data, length);
+
+	wrapper->view = previous_view;
+	return result;
+}
+
+// Feed every Buffer in 'messages' to the wrapper. While this runs, decoded frames as well as
+// acknowledgements, state changes and abandoned frames are appended to the returned array in the
+// order they occur, instead of calling back into JavaScript for each of them. The batch lives on
+// this function's stack, the wrapper merely points to it meanwhile.
+template <typename W>
+static
+Handle<Value> process_batch(W* wrapper, Local<Array> messages) {
+	Isolate* isolate = Isolate::GetCurrent();
+	Local<Context> context = isolate->GetCurrentContext();
+
+	FrameBatch batch {Array::New(isolate), 0};
+
+	FrameBatch* previous_batch = wrapper->batch;
+	wrapper->batch = &batch;
+
+	uint32_t length = messages->Length();
+	for (uint32_t i = 0; i < length; i++) {
+		Local<Value> message;
+		if (!messages->Get(context, i).ToLocal(&message)) break;
+
+		process_datagram(wrapper, message);
+	}
+
+	wrapper->batch = previous_batch;
+
+	return batch.frames;
+}
+
+// Decode every Buffer in 'messages' into the wrapper's columns. Returns the number of frames
+// stored in them.
+template <typename W>
+static
+uint32_t process_columns(W* wrapper, Local<Array> messages) {
+	FrameColumns* columns = wrapper->columns;
+	columns->attach(Isolate::GetCurrent());
+	columns->reset();
+
+	wrapper->columns_active = true;
+
+	Local<Context> context = Isolate::GetCurrent()->GetCurrentContext();
+
+	uint32_t length = messages->Length();
+	for (uint32_t i = 0; i < length; i++) {
+		Local<Value> message;
+		if (!messages->Get(context, i).ToLocal(&message)) break;
+
+		process_datagram(wrapper, message);
+	}
+
+	wrapper->columns_active = false;
+
+	columns->publish(Isolate::GetCurrent());
+	return columns->length;
+}
+
+// Add or remove the group addresses in 'addrs'. The filter is created by the first subscription,
+// until then every frame is accepted. Nothing changes if an entry is not a valid group address.
+template <typename W>
+static
+bool update_filter(W* wrapper, Local<Array> addrs, bool subscribe) {
+	Local<Context> context = Isolate::GetCurrent()->GetCurrentContext();
+	uint32_t length = addrs->Length();
+
+	for (uint32_t i = 0; i < length; i++) {
+		Local<Value> addr;
+
+		if (!addrs->Get(context, i).ToLocal(&addr) || !addr->IsUint32() || addr->Uint32Value() > 0xFFFF)
+			return false;
+	}
+
+	if (!wrapper->filter) {
+		if (!subscribe) return true;
+		wrapper->filter = new GroupFilter {};
+	}
+
+	for (uint32_t i = 0; i < length; i++) {
+		knx_addr addr = addrs->Get(context, i).ToLocalChecked()->Uint32Value();
+
+		if (subscribe)
+			wrapper->filter->subscribe(addr);
+		else
+			wrapper->filter->unsubscribe(addr);
+	}
+
+	return true;
+}
+
+// Register the DPT of a group address, so that its values are decoded before they are delivered.
+// 'dpt' is a DPT id or a libknxproto type, see 'knxproto_dpt_entry'.
+template <typename W>
+static
+bool register_dpt(W* wrapper, uint32_t addr, uint32_t dpt, bool with_payload) {
+	int entry = knxproto_dpt_entry(dpt);
+
+	if (addr > 0xFFFF || entry < 0)
+		return false;
+
+	if (!wrapper->dpts)
+		wrapper->dpts = new DptRegistry {};
+
+	wrapper->dpts->set(addr, entry, with_payload);
+	return true;
+}
+
+// Pace outbound frames at 'rate' telegrams per second. The scheduler is created by the first call,
+// later calls adjust it.
+template <typename W>
+static
+bool set_pacing(W* wrapper, double rate, double burst) {
+	if (!(rate > 0))
+		return false;
+
+	if (wrapper->pacing)
+		wrapper->pacing->configure(rate, burst);
+	else
+		wrapper->pacing = PacingScheduler::create({&W::pacing_send, &W::pacing_timeout}, wrapper, rate, burst, wrapper->loop);
+
+	wrapper->pacing->set_coalescing(wrapper->coalesce);
+
+	return true;
+}
+
+template <typename W>
+static
+Handle<Value> pacing_stats(W* wrapper) {
+	Isolate* isolate = Isolate::GetCurrent();
+	if (!wrapper->pacing) return Null(isolate);
+
+	// Lanes are indexed by L_Data priority, named like the Priority* constants
+	static const struct {
+		knx_ldata_prio priority;
+		const char* name;
+	} lane_names[4] = {
+		{KNX_LDATA_PRIO_SYSTEM, "system"},
+		{KNX_LDATA_PRIO_NORMAL, "normal"},
+		{KNX_LDATA_PRIO_URGENT, "urgent"},
+		{KNX_LDATA_PRIO_LOW,    "low"}
+	};
+
+	PacingScheduler* pacing = wrapper->pacing;
+	ObjectWrapper stats(isolate);
+
+	for (const auto& entry: lane_names) {
+		const PacingLane& lane = pacing->lanes[entry.priority & 3];
+		ObjectWrapper lane_wrapper(isolate);
+
+		lane_wrapper.set("depth", (uint32_t) lane.frames.length);
+		lane_wrapper.set("peak",  (uint32_t) lane.peak);
+		lane_wrapper.set("sent",  (double)   lane.sent);
+
+		stats.set(entry.name, Local<Value>(lane_wrapper));
+	}
+
+	stats.set("tokens", pacing->tokens);
+
+	return stats;
+}
+
+// Record the datagrams going through the wrapper in both directions to a capture log. Segments
+// are 'segment_size' bytes large, only the last 'max_segments' are kept unless that is zero.
+template <typename W>
+static
+bool start_capture(W* wrapper, Local<Value> path, double segment_size, uint32_t max_segments) {
+	if (wrapper->capture || !path->IsString() || !(segment_size > 0))
+		return false;
+
+	String::Utf8Value prefix(wrapper->isolate, path);
+	wrapper->capture = CaptureLog::open(std::string(*prefix, prefix.length()), (size_t) segment_size, max_segments);
+
+	return wrapper->capture != nullptr;
+}
+
+template <typename W>
+static
+Handle<Value> stop_capture(W* wrapper) {
+	Isolate* isolate = Isolate::GetCurrent();
+	if (!wrapper->capture) return Null(isolate);
+
+	CaptureLog* capture = wrapper->capture;
+	wrapper->capture = nullptr;
+
+	ObjectWrapper stats(isolate);
+
+	stats.set("records",  (double)   capture->records);
+	stats.set("bytes",    (double)   capture->bytes);
+	stats.set("dropped",  (double)   capture->dropped);
+	stats.set("segments", (uint32_t) (capture->segment - capture->first_segment + 1));
+
+	capture->close();
+
+	return stats;
+}
+
+// Drop frames for group addresses nobody has subscribed to, before any V8 work happens.
+template <typename W>
+static
+bool accept_frame(W* wrapper, const knx_cemi* frame) {
+	return !wrapper->filter || wrapper->filter->accept(*frame);
+}
+
+// Pack a frame decoded by the wrapper. Its payload may point into the datagram the wrapper is
+// processing, which is not necessarily the one another wrapper further up the stack is processing.
+template <typename W>
+static
+Local<Value> pack_frame(Isolate* isolate, W* wrapper, const knx_cemi* frame) {
+	const DatagramView* previous_view = current_view;
+	current_view = wrapper->view;
+
+	Local<Value> value = ValueWrapper<knx_cemi>::pack(isolate, *frame, wrapper->dpts);
+
+	current_view = previous_view;
+	return value;
+}
+
+// Hand a decoded frame to the pending batch or columns, if there are any.
+template <typename W>
+static
+bool collect_frame(v8::Isolate* isolate, W* wrapper, const knx_cemi* frame) {
+	if (wrapper->columns_active) {
+		wrapper->columns->append(*frame);
+		return true;
+	}
+
+	if (!wrapper->batch)
+		return false;
+
+	Local<Value> frame_value = pack_frame(isolate, wrapper, frame);
+	wrapper->batch->append(isolate, frame_value);
+	return true;
+}
+
+// Call into JavaScript, accounting the time spent there to the wrapper. Disposed wrappers do not
+// call back anymore.
+template <typename W>
+static
+void call_js(W* wrapper, Local<Function> callback, int argc, Local<Value>* args) {
+	if (wrapper->disposed) return;
+
+	Isolate* isolate = wrapper->isolate;
+	uint64_t start = uv_hrtime();
+
+	callback->Call(Local<Context>::New(isolate, wrapper->context), Null(isolate), argc, args);
+
+	wrapper->stats.called(uv_hrtime() - start);
+}
+
+// Acknowledgements, state changes and abandoned frames become objects with 'ack' and
+// 'destination', 'state' or 'abandon' respectively. Frames were copied, they do not belong to any
+// datagram.
+template <typename W>
+static
+Local<Value> pack_event(Isolate* isolate, W* wrapper, ProtocolMessage& event) {
+	switch (event.kind) {
+		case PROTOCOL_RECV:
+			return ValueWrapper<knx_cemi>::pack(isolate, event.frame.restore(), wrapper->dpts);
+
+		case PROTOCOL_ACK: {
+			ObjectWrapper ack(isolate);
+			ack.set("ack",         event.args[0]);
+			ack.set("destination", event.args[1]);
+
+			Local<Value> ack_value = ack;
+			return ack_value;
+		}
+
+		case PROTOCOL_STATE_CHANGE: {
+			ObjectWrapper state(isolate);
+			state.set("state", event.args[0]);
+
+			Local<Value> state_value = state;
+			return state_value;
+		}
+
+		case PROTOCOL_ABANDON: {
+			ObjectWrapper abandon(isolate);
+			abandon.set("abandon", event.args[0]);
+
+			Local<Value> abandon_value = abandon;
+			return abandon_value;
+		}
+
+		default:
+			return Null(isolate);
+	}
+}
+
+// Hand every held back event to the wrapper's delivery callback as one array, see 'pack_event'
+template <typename W>
+static
+void flush_delivery(W* wrapper) {
+	DeliveryBuffer* delivery = wrapper->delivery;
+	if (delivery->events.empty() || wrapper->disposed) return;
+
+	Isolate* isolate = wrapper->isolate;
+	Local<Context> context = Local<Context>::New(isolate, wrapper->context);
+	Local<Array> events = Array::New(isolate, delivery->events.size());
+
+	for (uint32_t i = 0; i < delivery->events.size(); i++) {
+		Local<Value> value = pack_event(isolate, wrapper, delivery->events[i]);
+		events->Set(context, i, value).FromMaybe(false);
+	}
+
+	delivery->clear();
+
+	Local<Function> callback = Local<Function>::New(isolate, wrapper->flush);
+
+	Local<Value> args[1] = {events};
+	call_js(wrapper, callback, 1, args);
+}
+
+// Hold back an event while a batch is processed or if the wrapper delivers them in batches.
+// Returns false if the event has to be delivered right away.
+template <typename W>
+static
+bool defer_event(W* wrapper, const ProtocolMessage& event) {
+	if (wrapper->batch) {
+		ProtocolMessage copy = event;
+		wrapper->batch->append(wrapper->isolate, pack_event(wrapper->isolate, wrapper, copy));
+
+		return true;
+	}
+
+	if (!wrapper->delivery) return false;
+
+	if (wrapper->delivery->push(event))
+		flush_delivery(wrapper);
+
+	return true;
+}
+
+template <typename W>
+static
+bool defer_frame(W* wrapper, const knx_cemi* frame) {
+	if (!wrapper->delivery) return false;
+
+	ProtocolMessage event;
+	event.kind = PROTOCOL_RECV;
+
+	return event.frame.store(*frame) && defer_event(wrapper, event);
+}
+
+// Pending events are flushed first
+template <typename W>
+static
+void disable_delivery(W* wrapper) {
+	if (!wrapper->delivery) return;
+
+	flush_delivery(wrapper);
+
+	wrapper->delivery->close();
+	wrapper->delivery = nullptr;
+	wrapper->flush.Reset();
+}
+
+// Deliver received frames and events in batches to 'callback' from now on, see 'DeliveryBuffer'
+template <typename W>
+static
+void enable_delivery(W* wrapper, Local<Function> callback, uint32_t max_events, double max_delay_us) {
+	disable_delivery(wrapper);
+
+	wrapper->flush.Reset(Isolate::GetCurrent(), callback);
+	wrapper->delivery = DeliveryBuffer::create(
+		&W::delivery_flush, wrapper,
+		max_events, (uint64_t) max_delay_us,
+		wrapper->loop
+	);
+}
+
+// Datagrams received by a native transport arrive from the event loop rather than a JavaScript
+// call, so the handlers need their own scope and must report exceptions to Node themselves. The
+// wrapper's context is entered and a callback scope runs microtasks and 'process.nextTick' callbacks
+// once the body is done, as 'node::MakeCallback' would. Nothing happens once the wrapper has been
+// disposed.
+template <typename W, typename B>
+static
+void process_from_loop(W* wrapper, B body) {
+	if (wrapper->disposed) return;
+
+	Isolate* isolate = wrapper->isolate;
+
+	HandleScope scope(isolate);
+	Context::Scope context_scope(Local<Context>::New(isolate, wrapper->context));
+	node::CallbackScope callback_scope(isolate, Local<Object>::New(isolate, wrapper->resource), {0, 0});
+	TryCatch try_catch(isolate);
+
+	body();
+
+	if (try_catch.HasCaught())
+		node::FatalException(isolate, try_catch);
+}
+
+// Counters shared by routers and tunnels, placed into an object of the given shape
+template <typename W>
+static
+Local<Object> pack_stats(W* wrapper, const Persistent<ObjectTemplate>& shape, uint32_t queue_depth) {
+	Isolate* isolate = wrapper->isolate;
+	const StatsShapes& ss = addon_state->stats;
+	const WireStats& stats = wrapper->stats;
+
+	Local<Object> object = frame_instantiate(isolate, shape);
+
+	frame_set(isolate, object, ss.datagrams_in,    (double) stats.datagrams_in.load());
+	frame_set(isolate, object, ss.datagrams_out,   (double) stats.datagrams_out.load());
+	frame_set(isolate, object, ss.bytes_in,        (double) stats.bytes_in.load());
+	frame_set(isolate, object, ss.bytes_out,       (double) stats.bytes_out.load());
+	frame_set(isolate, object, ss.frames_decoded,  (double) stats.frames_decoded.load());
+	frame_set(isolate, object, ss.decode_failures, (double) stats.decode_failures.load());
+	frame_set(isolate, object, ss.resends,         (double) stats.resends.load());
+	frame_set(isolate, object, ss.queue_depth,     queue_depth);
+	frame_set(isolate, object, ss.callbacks,       (double) stats.callbacks.load());
+
+	// Microseconds
+	frame_set(isolate, object, ss.callback_time,   stats.callback_time.load() / 1000.0);
+
+	return object;
+}
+
+// Values are in microseconds
+static
+Local<Object> pack_histogram(Isolate* isolate, const LatencyHistogram& histogram) {
+	const StatsShapes& ss = addon_state->stats;
+	Local<Object> object = frame_instantiate(isolate, ss.latency);
+
+	uint64_t count = histogram.count.load();
+
+	frame_set(isolate, object, ss.count, (double) count);
+	frame_set(isolate, object, ss.min,   (double) (count > 0 ? histogram.min.load() : 0));
+	frame_set(isolate, object, ss.max,   (double) histogram.max.load());
+	frame_set(isolate, object, ss.mean,  count > 0 ? (double) histogram.sum.load() / count : 0.0);
+	frame_set(isolate, object, ss.p50,   (double) histogram.percentile(50));
+	frame_set(isolate, object, ss.p90,   (double) histogram.percentile(90));
+	frame_set(isolate, object, ss.p99,   (double) histogram.percentile(99));
+	frame_set(isolate, object, ss.p999,  (double) histogram.percentile(99.9));
+
+	return object;
+}
+
+static
+void close_stats_timer(uv_timer_t* timer) {
+	uv_close((uv_handle_t*) timer, [](uv_handle_t* handle) {
+		delete (uv_timer_t*) handle;
+	});
+}
+
+// A wrapper may be disposed from one of its own callbacks, while native code further up the stack
+// still uses it. It stops calling into JavaScript right away and is released from a close callback,
+// which libuv only invokes after the current callback has returned.
+template <typename W>
+static
+void defer_release(W* wrapper) {
+	wrapper->disposed = true;
+
+	uv_check_t* handle = new uv_check_t;
+	uv_check_init(wrapper->loop, handle);
+	handle->data = wrapper;
+
+	uv_close((uv_handle_t*) handle, [](uv_handle_t* handle) {
+		W::release(handle->data);
+		delete (uv_check_t*) handle;
+	});
+}
+
+// Push the wrapper's statistics to 'callback' every 'interval' milliseconds, zero stops it. The
+// timer does not keep the event loop alive.
+template <typename W>
+static
+void set_stats_interval(W* wrapper, Local<Function> callback, uint32_t interval) {
+	if (wrapper->stats_timer) {
+		close_stats_timer(wrapper->stats_timer);
+
+		wrapper->stats_timer = nullptr;
+		wrapper->stats_callback.Reset();
+	}
+
+	if (interval == 0) return;
+
+	wrapper->stats_callback.Reset(wrapper->isolate, callback);
+	wrapper->stats_timer = new uv_timer_t;
+
+	uv_timer_init(wrapper->loop, wrapper->stats_timer);
+	uv_unref((uv_handle_t*) wrapper->stats_timer);
+	wrapper->stats_timer->data = wrapper;
+
+	uv_timer_start(wrapper->stats_timer, [](uv_timer_t* timer) {
+		W* wrapper = (W*) timer->data;
+
+		process_from_loop(wrapper, [=]() {
+			Isolate* isolate = wrapper->isolate;
+			Local<Function> callback = Local<Function>::New(isolate, wrapper->stats_callback);
+
+			Local<Value> args[1] = {W::pack_stats(wrapper)};
+			callback->Call(Local<Context>::New(isolate, wrapper->context), Null(isolate), 1, args);
+		});
+	}, interval, interval);
+}
+
+struct RouterWrapper {
+	Persistent<Function> send;
+	Persistent<Function> recv;
+	knx_router router;
+
+	// Present if the router owns its socket
+	UdpTransport* transport;
+
+	// Emit payloads as views onto the received datagram
+	bool zero_copy;
+
+	// Datagram being processed in zero-copy mode
+	const DatagramView* view;
+
+	// Only set during 'process_batch'
+	FrameBatch* batch;
+
+	// Present once columnar decoding has been enabled
+	FrameColumns* columns;
+	bool columns_active;
+
+	// Present once something has been subscribed
+	GroupFilter* filter;
+
+	// Last value of every group address
+	GroupValueCache cache;
+
+	// Present once a DPT has been registered
+	DptRegistry* dpts;
+
+	// Present once pacing has been enabled
+	PacingScheduler* pacing;
+
+	// Merge unsent writes to the same group address
+	bool coalesce;
+
+	// Present while received frames are delivered in batches to 'flush'
+	DeliveryBuffer* delivery;
+	Persistent<Function> flush;
+
+	// Isolate and event loop of the thread which created the wrapper
+	Isolate* isolate;
+	uv_loop_t* loop;
+
+	// Context the wrapper was created in and the resource of callbacks made from the event loop
+	Persistent<Context> context;
+	Persistent<Object> resource;
+
+	// Set by 'dispose', the wrapper is released later on
+	bool disposed;
+
+	WireStats stats;
+
+	// Present while statistics are pushed to 'stats_callback' periodically
+	uv_timer_t* stats_timer;
+	Persistent<Function> stats_callback;
+
+	// Present while datagrams are captured
+	CaptureLog* capture;
+
+	// Present while a capture log is replayed, 'replay_done' learns about its end
+	CaptureReplay* replay;
+	Persistent<Function> replay_done;
+
+	static
+	void* create(Local<Function> send, Local<Function> recv) {
+		Isolate* isolate = Isolate::GetCurrent();
+
+		RouterWrapper* wrapper = new RouterWrapper {
+			{isolate, send},
+			{isolate, recv}
+		};
+
+		wrapper->isolate = isolate;
+		wrapper->loop = addon_state->loop;
+		wrapper->context.Reset(isolate, isolate->GetCurrentContext());
+		wrapper->resource.Reset(isolate, Object::New(isolate));
+
+		// Wrappers which are still alive when their environment goes away are released along with it
+		node::AddEnvironmentCleanupHook(isolate, &RouterWrapper::release, wrapper);
+
+		knx_router_set_send_handler(&wrapper->router, (knx_router_send_cb) &RouterWrapper::cb_send, wrapper);
+		knx_router_set_recv_handler(&wrapper->router, (knx_router_recv_cb) &RouterWrapper::cb_recv, wrapper);
+
+		return wrapper;
+	}
+
+	static
+	bool process(void* router, Local<Value> message) {
+		if (!router) return false;
+
+		return process_datagram((RouterWrapper*) router, message);
+	}
+
+	static
+	Handle<Value> process_batch(void* router, Local<Array> messages) {
+		if (!router) return Null(Isolate::GetCurrent());
+
+		return ::process_batch((RouterWrapper*) router, messages);
+	}
+
+	static
+	Handle<Value> enable_columns(void* router, uint32_t capacity, uint32_t arena_size) {
+		Isolate* isolate = Isolate::GetCurrent();
+		if (!router || capacity == 0 || arena_size == 0) return Null(isolate);
+
+		RouterWrapper* wrapper = (RouterWrapper*) router;
+		delete wrapper->columns;
+
+		wrapper->columns = FrameColumns::create(isolate, capacity, arena_size);
+		return Local<Object>::New(isolate, wrapper->columns->object);
+	}
+
+	static
+	bool subscribe(void* router, Local<Array> addrs) {
+		return router && update_filter((RouterWrapper*) router, addrs, true);
+	}
+
+	static
+	bool unsubscribe(void* router, Local<Array> addrs) {
+		return router && update_filter((RouterWrapper*) router, addrs, false);
+	}
+
+	static
+	Handle<Value> lookup(void* router, uint32_t addr) {
+		Isolate* isolate = Isolate::GetCurrent();
+		if (!router || addr > 0xFFFF) return Null(isolate);
+
+		return ((RouterWrapper*) router)->cache.lookup(isolate, addr);
+	}
+
+	static
+	Handle<Value> snapshot(void* router) {
+		Isolate* isolate = Isolate::GetCurrent();
+		if (!router) return Null(isolate);
+
+		return ((RouterWrapper*) router)->cache.snapshot(isolate);
+	}
+
+	static
+	bool register_dpt(void* router, uint32_t addr, uint32_t dpt, bool with_payload) {
+		return router && ::register_dpt((RouterWrapper*) router, addr, dpt, with_payload);
+	}
+
+	static
+	void unregister_dpt(void* router, uint32_t addr) {
+		if (!router) return;
+
+		RouterWrapper* wrapper = (RouterWrapper*) router;
+		if (wrapper->dpts && addr <= 0xFFFF) wrapper->dpts->clear(addr);
+	}
+
+	static
+	double filtered(void* router) {
+		if (!router) return 0;
+
+		RouterWrapper* wrapper = (RouterWrapper*) router;
+		return wrapper->filter ? wrapper->filter->filtered : 0;
+	}
+
+	static
+	uint32_t process_columns(void* router, Local<Array> messages) {
+		if (!router) return 0;
+
+		RouterWrapper* wrapper = (RouterWrapper*) router;
+		if (!wrapper->columns) return 0;
+
+		return ::process_columns(wrapper, messages);
+	}
+
+	static
+	void set_zero_copy(void* router, bool enabled) {
+		if (router) ((RouterWrapper*) router)->zero_copy = enabled;
+	}
+
+	// The cEMI frame follows the KNXnet/IP header
+	static
+	size_t cemi_offset(const uint8_t* message, size_t message_size) {
+		if (message_size < 1 || message[0] > message_size)
+			return message_size;
+
+		return message[0];
+	}
+
+	static
+	bool process_raw(RouterWrapper* wrapper, const uint8_t* message, size_t message_size) {
+		if (wrapper->disposed) return false;
+
+		if (wrapper->capture) wrapper->capture->append(uv_hrtime(), CAPTURE_INBOUND, message, message_size);
+
+		bool accepted = knx_router_process(&wrapper->router, message, message_size);
+		wrapper->stats.received(message_size, accepted);
+
+		return accepted;
+	}
+
+	static
+	void m_send(void* router, Local<Value> frame) {
+		knx_cemi cemi;
+		if (!router || !unmarshal_argument(frame, cemi)) return;
+
+		RouterWrapper* wrapper = (RouterWrapper*) router;
+
+		if (wrapper->pacing)
+			wrapper->pacing->push(cemi);
+		else
+			knx_router_send(&wrapper->router, &cemi);
+	}
+
+	static
+	bool set_pacing(void* router, double rate, double burst) {
+		return router && ::set_pacing((RouterWrapper*) router, rate, burst);
+	}
+
+	static
+	Handle<Value> pacing_stats(void* router) {
+		if (!router) return Null(Isolate::GetCurrent());
+
+		return ::pacing_stats((RouterWrapper*) router);
+	}
+
+	static
+	void enable_delivery(void* router, Local<Function> callback, uint32_t max_events, double max_delay_us) {
+		if (router) ::enable_delivery((RouterWrapper*) router, callback, max_events, max_delay_us);
+	}
+
+	static
+	void disable_delivery(void* router) {
+		if (router) ::disable_delivery((RouterWrapper*) router);
+	}
+
+	static
+	void delivery_flush(void* router) {
+		RouterWrapper* wrapper = (RouterWrapper*) router;
+		process_from_loop(wrapper, [=]() {
+			flush_delivery(wrapper);
+		});
+	}
+
+	static
+	Local<Object> pack_stats(RouterWrapper* wrapper) {
+		uint32_t queue_depth = wrapper->pacing ? wrapper->pacing->length() : 0;
+		return ::pack_stats(wrapper, addon_state->stats.router, queue_depth);
+	}
+
+	static
+	Handle<Value> get_stats(void* router) {
+		if (!router) return Null(Isolate::GetCurrent());
+
+		return pack_stats((RouterWrapper*) router);
+	}
+
+	static
+	void set_stats_interval(void* router, Local<Function> callback, uint32_t interval) {
+		if (router) ::set_stats_interval((RouterWrapper*) router, callback, interval);
+	}
+
+	static
+	bool start_capture(void* router, Local<Value> path, double segment_size, uint32_t max_segments) {
+		return router && ::start_capture((RouterWrapper*) router, path, segment_size, max_segments);
+	}
+
+	static
+	Handle<Value> stop_capture(void* router) {
+		if (!router) return Null(Isolate::GetCurrent());
+
+		return ::stop_capture((RouterWrapper*) router);
+	}
+
+	// Feed the received datagrams of a capture log through the router as if they had just arrived,
+	// 'speed' times as fast as they were recorded or as fast as possible if it is zero. 'done'
+	// receives the number of datagrams fed.
+	static
+	bool replay(void* router, Local<Value> path, double speed, Local<Function> done) {
+		if (!router || !path->IsString()) return false;
+
+		RouterWrapper* wrapper = (RouterWrapper*) router;
+		if (wrapper->replay) return false;
+
+		String::Utf8Value prefix(wrapper->isolate, path);
+
+		CaptureReader* reader = CaptureReader::open(std::string(*prefix, prefix.length()));
+		if (!reader) return false;
+
+		wrapper->replay_done.Reset(wrapper->isolate, done);
+		wrapper->replay = CaptureReplay::create(
+			{&RouterWrapper::replay_feed, &RouterWrapper::replay_timeout, &RouterWrapper::replay_finished},
+			wrapper, reader, speed, wrapper->loop
+		);
+
+		return true;
+	}
+
+	static
+	void stop_replay(void* router) {
+		if (router && ((RouterWrapper*) router)->replay)
+			((RouterWrapper*) router)->replay->stop();
+	}
+
+	// Replayed datagrams are not captured again
+	static
+	void replay_feed(void* router, const uint8_t* message, size_t message_size) {
+		RouterWrapper* wrapper = (RouterWrapper*) router;
+		if (wrapper->disposed) return;
+
+		bool accepted = knx_router_process(&wrapper->router, message, message_size);
+		wrapper->stats.received(message_size, accepted);
+	}
+
+	static
+	void replay_timeout(void* router) {
+		RouterWrapper* wrapper = (RouterWrapper*) router;
+		process_from_loop(wrapper, [=]() {
+			wrapper->replay->pump();
+		});
+	}
+
+	static
+	void replay_finished(void* router, uint64_t fed) {
+		RouterWrapper* wrapper = (RouterWrapper*) router;
+		wrapper->replay = nullptr;
+
+		v8::Isolate* isolate = wrapper->isolate;
+		Local<Function> callback = Local<Function>::New(isolate, wrapper->replay_done);
+		wrapper->replay_done.Reset();
+
+		Local<Value> args[1] = {Number::New(isolate, (double) fed)};
+		call_js(wrapper, callback, 1, args);
+	}
+
+	// Frames only wait in the router while it is paced, so there is nothing to coalesce otherwise
+	static
+	void set_coalescing(void* router, bool enable) {
+		if (!router) return;
+
+		RouterWrapper* wrapper = (RouterWrapper*) router;
+		wrapper->coalesce = enable;
+
+		if (wrapper->pacing) wrapper->pacing->set_coalescing(enable);
+	}
+
+	static
+	double coalesced(void* router) {
+		if (!router) return 0;
+
+		RouterWrapper* wrapper = (RouterWrapper*) router;
+		return wrapper->pacing ? wrapper->pacing->coalesced() : 0;
+	}
+
+	static
+	bool pacing_send(void* router, const knx_cemi* frame) {
+		RouterWrapper* wrapper = (RouterWrapper*) router;
+		knx_router_send(&wrapper->router, frame);
+
+		return true;
+	}
+
+	static
+	void pacing_timeout(void* router) {
+		RouterWrapper* wrapper = (RouterWrapper*) router;
+		process_from_loop(wrapper, [=]() {
+			wrapper->pacing->pump();
+		});
+	}
+
+	static
+	bool open(void* router, uint32_t address, uint32_t port, bool loopback) {
+		if (!router) return false;
+
+		RouterWrapper* wrapper = (RouterWrapper*) router;
+		if (wrapper->transport) return false;
+
+		wrapper->transport = UdpTransport::open(
+			address, port, true, loopback,
+			(UdpTransport::RecvHandler) &RouterWrapper::transport_recv, wrapper,
+			wrapper->loop
+		);
+
+		return wrapper->transport != nullptr;
+	}
+
+	static
+	void dispose(void* router) {
+		if (!router || ((RouterWrapper*) router)->disposed) return;
+
+		RouterWrapper* wrapper = (RouterWrapper*) router;
+		node::RemoveEnvironmentCleanupHook(wrapper->isolate, &RouterWrapper::release, wrapper);
+
+		defer_release(wrapper);
+	}
+
+	static
+	void release(void* router) {
+		RouterWrapper* wrapper = (RouterWrapper*) router;
+		if (wrapper->stats_timer) close_stats_timer(wrapper->stats_timer);
+		if (wrapper->replay) wrapper->replay->close();
+		if (wrapper->capture) wrapper->capture->close();
+		if (wrapper->transport) wrapper->transport->close();
+		if (wrapper->pacing) wrapper->pacing->close();
+		if (wrapper->delivery) wrapper->delivery->close();
+
+		delete wrapper->columns;
+		delete wrapper->filter;
+		delete wrapper->dpts;
+
+		wrapper->context.Reset();
+		wrapper->resource.Reset();
+		delete wrapper;
+	}
+
+	static
+	void transport_recv(RouterWrapper* wrapper, const uint8_t* message, size_t message_size) {
+		process_from_loop(wrapper, [=]() {
+			process_raw(wrapper, message, message_size);
+		});
+	}
+
+	static
+	void cb_send(
+		const knx_router* router,
+		RouterWrapper*    wrapper,
+		const uint8_t*    message,
+		size_t            message_size
+	) {
+		wrapper->stats.sent(message_size);
+		if (wrapper->capture) wrapper->capture->append(uv_hrtime(), CAPTURE_OUTBOUND, message, message_size);
+
+		if (wrapper->transport) {
+			wrapper->transport->send(message, message_size);
+			return;
+		}
+
+		v8::Isolate* isolate = wrapper->isolate;
+		Local<Function> callback = Local<Function>::New(isolate, wrapper->send);
+
+		Local<Value> args[1] = {copy_buffer((const char*) message, message_size)};
+		call_js(wrapper, callback, 1, args);
+	}
+
+	static
+	void cb_recv(
+		const knx_router* router,
+		RouterWrapper*    wrapper,
+		const knx_cemi*   frame
+	) {
+		wrapper->stats.frames_decoded.fetch_add(1, std::memory_order_relaxed);
+		wrapper->cache.update(*frame);
+		if (!accept_frame(wrapper, frame)) return;
+
+		v8::Isolate* isolate = wrapper->isolate;
+		if (collect_frame(isolate, wrapper, frame) || defer_frame(wrapper, frame)) return;
+
+		Local<Function> callback = Local<Function>::New(isolate, wrapper->recv);
+
+		Local<Value> args[1] = {pack_frame(isolate, wrapper, frame)};
+		call_js(wrapper, callback, 1, args);
+	}
+};
+
+struct TunnelWrapper {
+	Persistent<Function> state_change;
+	Persistent<Function> send;
+	Persistent<Function> recv;
+	Persistent<Function> ack;
+	Persistent<Function> abandon;
+	knx_tunnel tunnel;
+
+	// Present if the tunnel owns its socket
+	UdpTransport* transport;
+
+	// Emit payloads as views onto the received datagram
+	bool zero_copy;
+
+	// Datagram being processed in zero-copy mode
+	const DatagramView* view;
+
+	// Only set during 'process_batch'
+	FrameBatch* batch;
+
+	// Present once columnar decoding has been enabled
+	FrameColumns* columns;
+	bool columns_active;
+
+	// Present once something has been subscribed
+	GroupFilter* filter;
+
+	// Last value of every group address
+	GroupValueCache cache;
+
+	// Present once a DPT has been registered
+	DptRegistry* dpts;
+
+	// Frames waiting for their turn to be sent
+	OutboundQueue* queue;
+
+	// Present once pacing has been enabled, frames pass through it before entering the queue
+	PacingScheduler* pacing;
+
+	// Merge unsent writes to the same group address
+	bool coalesce;
+
+	// Present if the protocol runs on a thread of its own. The tunnel, its transport, queue and
+	// scheduler then belong to that thread; everything else stays on the JavaScript thread.
+	ProtocolWorker* worker;
+
+	// Present while received frames, acknowledgements and state changes are delivered in batches
+	// to 'flush'
+	DeliveryBuffer* delivery;
+	Persistent<Function> flush;
+
+	// Microseconds from the first transmission of a queued frame until its acknowledgement
+	LatencyHistogram ack_latency;
+
+	// Frames dropped after all retransmissions and the current retransmission timeout in
+	// milliseconds, kept here as the queue may belong to the worker
+	std::atomic<uint64_t> abandoned;
+	std::atomic<uint64_t> retransmit_timeout;
+
+	// Set when a frame has been abandoned, the tunnel connects again once it is disconnected. Like
+	// the queue, it belongs to the worker if there is one.
+	bool resync;
+
+	// Isolate and event loop of the thread which created the wrapper
+	Isolate* isolate;
+	uv_loop_t* loop;
+
+	// Context the wrapper was created in and the resource of callbacks made from the event loop
+	Persistent<Context> context;
+	Persistent<Object> resource;
+
+	// Set by 'dispose', the wrapper is released later on
+	bool disposed;
+
+	WireStats stats;
+
+	// Present while statistics are pushed to 'stats_callback' periodically
+	uv_timer_t* stats_timer;
+	Persistent<Function> stats_callback;
+
+	// Present while datagrams are captured. Like the queue, it belongs to the worker if there is one.
+	CaptureLog* capture;
+
+	static
+	void* create(
+		Local<Function> state_change,
+		Local<Function> send,
+		Local<Function> recv,
+		Local<Function> ack,
+		Local<Function> abandon
+	) {
+		Isolate* isolate = Isolate::GetCurrent();
+
+		TunnelWrapper* wrapper = new TunnelWrapper {
+			{isolate, state_change},
+			{isolate, send},
+			{isolate, recv},
+			{isolate, ack},
+			{isolate, abandon}
+		};
+
+		wrapper->isolate = isolate;
+		wrapper->loop = addon_state->loop;
+		wrapper->context.Reset(isolate, isolate->GetCurrentContext());
+		wrapper->resource.Reset(isolate, Object::New(isolate));
+
+		node::AddEnvironmentCleanupHook(isolate, &TunnelWrapper::release, wrapper);
+
+		knx_tunnel_init(&wrapper->tunnel);
+		knx_tunnel_set_send_handler(&wrapper->tunnel, (knx_tunnel_send_cb) &TunnelWrapper::cb_send, wrapper);
+		knx_tunnel_set_recv_handler(&wrapper->tunnel, (knx_tunnel_recv_cb) &TunnelWrapper::cb_recv, wrapper);
+		knx_tunnel_set_state_change_handler(&wrapper->tunnel, (knx_tunnel_state_change_cb) &TunnelWrapper::cb_state_change, wrapper);
+		knx_tunnel_set_ack_handler(&wrapper->tunnel, (knx_tunnel_ack_cb) &TunnelWrapper::cb_ack, wrapper);
+
+		wrapper->queue = OutboundQueue::create(
+			{
+				&TunnelWrapper::queue_send, &TunnelWrapper::queue_resend,
+				&TunnelWrapper::queue_timeout, &TunnelWrapper::queue_abandon
+			},
+			wrapper, 1000, wrapper->loop
+		);
+
+		wrapper->retransmit_timeout = wrapper->queue->rtt.timeout();
+
+		return wrapper;
+	}
+
+	static
+	void dispose(void* tunnel) {
+		if (!tunnel || ((TunnelWrapper*) tunnel)->disposed) return;
+
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+		node::RemoveEnvironmentCleanupHook(wrapper->isolate, &TunnelWrapper::release, wrapper);
+
+		defer_release(wrapper);
+	}
+
+	static
+	void release(void* tunnel) {
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+
+		if (wrapper->worker) {
+			wrapper->worker->close();
+		} else {
+			if (wrapper->transport) wrapper->transport->close();
+			wrapper->queue->close();
+			if (wrapper->pacing) wrapper->pacing->close();
+		}
+
+		if (wrapper->delivery) wrapper->delivery->close();
+		if (wrapper->stats_timer) close_stats_timer(wrapper->stats_timer);
+
+		// The worker, if any, has been joined by now
+		if (wrapper->capture) wrapper->capture->close();
+
+		delete wrapper->columns;
+		delete wrapper->filter;
+		delete wrapper->dpts;
+
+		wrapper->context.Reset();
+		wrapper->resource.Reset();
+		delete wrapper;
+	}
+
+	static
+	bool open(void* tunnel, uint32_t address, uint32_t port) {
+		if (!tunnel) return false;
+
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+		if (wrapper->transport) return false;
+
+		wrapper->transport = UdpTransport::open(
+			address, port, false, false,
+			(UdpTransport::RecvHandler) &TunnelWrapper::transport_recv, wrapper,
+			wrapper->loop
+		);
+
+		return wrapper->transport != nullptr;
+	}
+
+	// Like 'open', but the socket, protocol state machine and outbound queue are moved to a worker
+	// thread, so that acknowledgements and retransmissions are not held up by the JavaScript thread.
+	static
+	bool start_worker(void* tunnel, uint32_t address, uint32_t port) {
+		if (!tunnel) return false;
+
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+		if (wrapper->transport || wrapper->worker) return false;
+
+		ProtocolWorker* worker = ProtocolWorker::create(
+			{
+				&TunnelWrapper::worker_command, &TunnelWrapper::worker_stop,
+				&TunnelWrapper::worker_wake, &TunnelWrapper::worker_pause
+			},
+			wrapper, wrapper->loop
+		);
+
+		// The worker loop does not run yet, so its handles can still be set up from here
+		wrapper->transport = UdpTransport::open(
+			address, port, false, false,
+			(UdpTransport::RecvHandler) &TunnelWrapper::transport_recv, wrapper,
+			&worker->loop
+		);
+
+		if (!wrapper->transport) {
+			worker->close();
+			return false;
+		}
+
+		move_outbound(wrapper, &worker->loop);
+
+		wrapper->worker = worker;
+		update_backlog(wrapper);
+
+		if (!worker->run()) {
+			// Back to the Node event loop with every queued frame, as if the worker had never been
+			// started. The worker's handles are closed by 'close' without it being installed.
+			wrapper->worker = nullptr;
+			move_outbound(wrapper, wrapper->loop);
+
+			wrapper->transport->close();
+			wrapper->transport = nullptr;
+
+			worker->close();
+			return false;
+		}
+
+		return true;
+	}
+
+	// Replace the queue and the scheduler with ones on 'loop', taking over their configuration and
+	// frames. Neither loop may be running on another thread.
+	static
+	void move_outbound(TunnelWrapper* wrapper, uv_loop_t* loop) {
+		OutboundQueue* queue = OutboundQueue::create(
+			{
+				&TunnelWrapper::queue_send, &TunnelWrapper::queue_resend,
+				&TunnelWrapper::queue_timeout, &TunnelWrapper::queue_abandon
+			},
+			wrapper, 1000, loop
+		);
+
+		queue->frames.set_coalescing(wrapper->coalesce);
+		queue->configure(wrapper->queue->rtt.min_rto, wrapper->queue->rtt.max_rto, wrapper->queue->max_retries);
+		move_ring(wrapper->queue->frames, queue->frames);
+
+		wrapper->queue->close();
+		wrapper->queue = queue;
+
+		if (wrapper->pacing) {
+			PacingScheduler* pacing = PacingScheduler::create(
+				{&TunnelWrapper::pacing_send, &TunnelWrapper::pacing_timeout},
+				wrapper, wrapper->pacing->rate, wrapper->pacing->burst, loop
+			);
+
+			pacing->set_coalescing(wrapper->coalesce);
+
+			for (size_t i = 0; i < 4; i++)
+				move_ring(wrapper->pacing->lanes[i].frames, pacing->lanes[i].frames);
+
+			wrapper->pacing->close();
+			wrapper->pacing = pacing;
+		}
+	}
+
+	static
+	void move_ring(FrameRing& from, FrameRing& to) {
+		for (; from.length > 0; from.pop())
+			to.push(from.front().cemi);
+	}
+
+	// Worker thread
+	static
+	void update_backlog(TunnelWrapper* wrapper) {
+		wrapper->worker->backlog = wrapper->queue->frames.length + (wrapper->pacing ? wrapper->pacing->length() : 0);
+	}
+
+	// Worker thread
+	static
+	void worker_command(void* tunnel, ProtocolMessage& message) {
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+
+		switch (message.kind) {
+			case PROTOCOL_SEND:
+				push_frame(wrapper, message.frame.restore());
+				break;
+
+			case PROTOCOL_CONNECT:
+				knx_tunnel_connect(&wrapper->tunnel);
+				break;
+
+			case PROTOCOL_DISCONNECT:
+				knx_tunnel_disconnect(&wrapper->tunnel);
+				break;
+
+			default:
+				break;
+		}
+
+		update_backlog(wrapper);
+	}
+
+	// Worker thread
+	static
+	void worker_stop(void* tunnel) {
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+
+		// Only the worker's handles are closed, the worker may not have been installed yet
+		if (!wrapper->worker) return;
+
+		wrapper->transport->close();
+		wrapper->queue->close();
+		if (wrapper->pacing) wrapper->pacing->close();
+	}
+
+	// Worker thread. Datagrams wait in the socket's buffer while the JavaScript thread catches up.
+	static
+	void worker_pause(void* tunnel, bool paused) {
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+
+		if (paused)
+			wrapper->transport->pause();
+		else
+			wrapper->transport->resume();
+	}
+
+	static
+	void worker_wake(void* tunnel) {
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+
+		process_from_loop(wrapper, [=]() {
+			ProtocolMessage message;
+
+			// The callbacks may dispose the wrapper, the remaining events are dropped then
+			while (!wrapper->disposed && wrapper->worker->next(message)) {
+				switch (message.kind) {
+					case PROTOCOL_RECV:
+						deliver(wrapper, &message.frame.restore());
+						break;
+
+					case PROTOCOL_STATE_CHANGE:
+						notify_state_change(wrapper, message.args[0]);
+						break;
+
+					case PROTOCOL_ACK:
+						notify_ack(wrapper, message.args[0], message.args[1]);
+						break;
+
+					case PROTOCOL_ABANDON:
+						notify_abandon(wrapper, message.args[0]);
+						break;
+
+					default:
+						break;
+				}
+			}
+		});
+	}
+
+	static
+	void enable_delivery(void* tunnel, Local<Function> callback, uint32_t max_events, double max_delay_us) {
+		if (tunnel) ::enable_delivery((TunnelWrapper*) tunnel, callback, max_events, max_delay_us);
+	}
+
+	static
+	void disable_delivery(void* tunnel) {
+		if (tunnel) ::disable_delivery((TunnelWrapper*) tunnel);
+	}
+
+	static
+	void delivery_flush(void* tunnel) {
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+		process_from_loop(wrapper, [=]() {
+			flush_delivery(wrapper);
+		});
+	}
+
+	// Safe while there is a worker, all counters are atomic
+	static
+	Local<Object> pack_stats(TunnelWrapper* wrapper) {
+		Isolate* isolate = wrapper->isolate;
+		Local<Object> object = ::pack_stats(wrapper, addon_state->stats.tunnel, queued(wrapper));
+
+		frame_set(isolate, object, addon_state->stats.ack_latency, pack_histogram(isolate, wrapper->ack_latency));
+		frame_set(isolate, object, addon_state->stats.abandoned, (double) wrapper->abandoned.load());
+		frame_set(isolate, object, addon_state->stats.retransmit_timeout, (double) wrapper->retransmit_timeout.load());
+		frame_set(isolate, object, addon_state->stats.dropped, (double) (wrapper->worker ? wrapper->worker->dropped.load() : 0));
+
+		return object;
+	}
+
+	static
+	Handle<Value> get_stats(void* tunnel) {
+		if (!tunnel) return Null(Isolate::GetCurrent());
+
+		return pack_stats((TunnelWrapper*) tunnel);
+	}
+
+	static
+	void set_stats_interval(void* tunnel, Local<Function> callback, uint32_t interval) {
+		if (tunnel) ::set_stats_interval((TunnelWrapper*) tunnel, callback, interval);
+	}
+
+	// Capturing has to be started before the worker and can only be stopped without one
+	static
+	bool start_capture(void* tunnel, Local<Value> path, double segment_size, uint32_t max_segments) {
+		return tunnel && !((TunnelWrapper*) tunnel)->worker &&
+		       ::start_capture((TunnelWrapper*) tunnel, path, segment_size, max_segments);
+	}
+
+	static
+	Handle<Value> stop_capture(void* tunnel) {
+		if (!tunnel || ((TunnelWrapper*) tunnel)->worker) return Null(Isolate::GetCurrent());
+
+		return ::stop_capture((TunnelWrapper*) tunnel);
+	}
 
-				case KNX_TPCI_UNNUMBERED_CONTROL:
-					tpdu.info.control = (knx_tpci_control) wrapper.get<uint32_t>("control");
+	static
+	bool submit(TunnelWrapper* wrapper, ProtocolMessageKind kind) {
+		ProtocolMessage message;
+		message.kind = kind;
 
-					break;
-			}
+		return wrapper->worker->submit(message);
+	}
 
-			return tpdu;
+	static
+	void transport_recv(TunnelWrapper* wrapper, const uint8_t* message, size_t message_size) {
+		if (wrapper->worker) {
+			process_raw(wrapper, message, message_size);
+			return;
 		}
 
-		static inline
-		ObjectWrapper pack(v8::Isolate* isolate, const knx_tpdu& value) {
-			ObjectWrapper wrapper(isolate);
+		process_from_loop(wrapper, [=]() {
+			process_raw(wrapper, message, message_size);
+		});
+	}
 
-			wrapper.set("tpci", (uint32_t) value.tpci);
+	static
+	void connect(void* tunnel) {
+		if (!tunnel) return;
 
-			switch (value.tpci) {
-				case KNX_TPCI_NUMBERED_DATA:
-					wrapper.set("sequenceNumber", (uint32_t) value.seq_number);
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
 
-				case KNX_TPCI_UNNUMBERED_DATA:
-					wrapper.set("apci", (uint32_t) value.info.data.apci);
-					wrapper.set("payload", copy_buffer((const char*) value.info.data.payload, value.info.data.length));
+		if (wrapper->worker)
+			submit(wrapper, PROTOCOL_CONNECT);
+		else
+			knx_tunnel_connect(&wrapper->tunnel);
+	}
 
-					break;
+	// Datagrams are received by the worker itself while there is one
+	static
+	bool process(void* tunnel, Local<Value> message) {
+		if (!tunnel || ((TunnelWrapper*) tunnel)->worker) return false;
 
-				case KNX_TPCI_NUMBERED_CONTROL:
-					wrapper.set("sequenceNumber", (uint32_t) value.seq_number);
+		return process_datagram((TunnelWrapper*) tunnel, message);
+	}
 
-				case KNX_TPCI_UNNUMBERED_CONTROL:
-					wrapper.set("control", (uint32_t) value.info.control);
+	static
+	Handle<Value> process_batch(void* tunnel, Local<Array> messages) {
+		if (!tunnel || ((TunnelWrapper*) tunnel)->worker) return Null(Isolate::GetCurrent());
 
-					break;
-			}
+		return ::process_batch((TunnelWrapper*) tunnel, messages);
+	}
 
-			return wrapper;
-		}
-	};
+	static
+	Handle<Value> enable_columns(void* tunnel, uint32_t capacity, uint32_t arena_size) {
+		Isolate* isolate = Isolate::GetCurrent();
+		if (!tunnel || capacity == 0 || arena_size == 0) return Null(isolate);
 
-	template <>
-	struct ValueWrapper<knx_ldata> {
-		static
-		constexpr const char* TypeName = "L_Data";
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+		delete wrapper->columns;
 
-		static inline
-		bool check(v8::Local<v8::Value> value) {
-			if (!ValueWrapper<ObjectWrapper>::check(value))
-				return false;
+		wrapper->columns = FrameColumns::create(isolate, capacity, arena_size);
+		return Local<Object>::New(isolate, wrapper->columns->object);
+	}
 
-			ObjectWrapper wrapper = ValueWrapper<ObjectWrapper>::unpack(value);
-			return wrapper.expect<uint32_t>("destination") && wrapper.expect<knx_tpdu>("tpdu");
-		}
+	static
+	bool subscribe(void* tunnel, Local<Array> addrs) {
+		return tunnel && update_filter((TunnelWrapper*) tunnel, addrs, true);
+	}
 
-		static inline
-		knx_ldata unpack(v8::Local<v8::Value> value) {
-			ObjectWrapper wrapper = ValueWrapper<ObjectWrapper>::unpack(value);
-			knx_ldata ldata;
+	static
+	bool unsubscribe(void* tunnel, Local<Array> addrs) {
+		return tunnel && update_filter((TunnelWrapper*) tunnel, addrs, false);
+	}
+
+	static
+	Handle<Value> lookup(void* tunnel, uint32_t addr) {
+		Isolate* isolate = Isolate::GetCurrent();
+		if (!tunnel || addr > 0xFFFF) return Null(isolate);
+
+		return ((TunnelWrapper*) tunnel)->cache.lookup(isolate, addr);
+	}
 
-			// Control 1
-			ldata.control1.priority = wrapper.check<uint32_t>("priority")
-			                        ? (knx_ldata_prio) wrapper.get<uint32_t>("priority")
-			                        : KNX_LDATA_PRIO_LOW;
+	static
+	Handle<Value> snapshot(void* tunnel) {
+		Isolate* isolate = Isolate::GetCurrent();
+		if (!tunnel) return Null(isolate);
+
+		return ((TunnelWrapper*) tunnel)->cache.snapshot(isolate);
+	}
 
-			ldata.control1.repeat = wrapper.check<bool>("repeat")
-			                      ? wrapper.get<bool>("repeat")
-			                      : true;
+	static
+	bool register_dpt(void* tunnel, uint32_t addr, uint32_t dpt, bool with_payload) {
+		return tunnel && ::register_dpt((TunnelWrapper*) tunnel, addr, dpt, with_payload);
+	}
 
-			ldata.control1.system_broadcast = wrapper.check<bool>("systemBroadcast")
-			                                ? wrapper.get<bool>("systemBroadcast")
-			                                : true;
+	static
+	void unregister_dpt(void* tunnel, uint32_t addr) {
+		if (!tunnel) return;
 
-			ldata.control1.request_ack = wrapper.check<bool>("requestAck")
-			                           ? wrapper.get<bool>("requestAck")
-			                           : true;
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+		if (wrapper->dpts && addr <= 0xFFFF) wrapper->dpts->clear(addr);
+	}
 
-			ldata.control1.error = wrapper.check<bool>("error")
-			                     ? wrapper.get<bool>("error")
-			                     : false;
+	static
+	double filtered(void* tunnel) {
+		if (!tunnel) return 0;
 
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+		return wrapper->filter ? wrapper->filter->filtered : 0;
+	}
 
-			// Control 2
-			ldata.control2.address_type = wrapper.check<uint32_t>("addressType")
-			                            ? (knx_ldata_addr_type) wrapper.get<uint32_t>("addressType")
-			                            : KNX_LDATA_ADDR_GROUP;
+	static
+	uint32_t process_columns(void* tunnel, Local<Array> messages) {
+		if (!tunnel) return 0;
 
-			ldata.control2.hops = wrapper.check<uint32_t>("hops")
-			                    ? wrapper.get<uint32_t>("hops")
-			                    : 7;
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+		if (!wrapper->columns || wrapper->worker) return 0;
 
-			// Addresses
-			ldata.source = wrapper.check<uint32_t>("source")
-			             ? (knx_addr) wrapper.get<uint32_t>("source")
-			             : 0;
+		return ::process_columns(wrapper, messages);
+	}
 
-			ldata.destination = (knx_addr) wrapper.get<uint32_t>("destination");
+	static
+	void set_zero_copy(void* tunnel, bool enabled) {
+		if (tunnel) ((TunnelWrapper*) tunnel)->zero_copy = enabled;
+	}
 
-			// Transport unit
-			ldata.tpdu = wrapper.get<knx_tpdu>("tpdu");
+	// The cEMI frame follows the KNXnet/IP header and the connection header
+	static
+	size_t cemi_offset(const uint8_t* message, size_t message_size) {
+		if (message_size < 1 || message[0] >= message_size)
+			return message_size;
 
-			return ldata;
-		}
+		size_t offset = message[0] + message[message[0]];
+		return offset > message_size ? message_size : offset;
+	}
 
-		static inline
-		ObjectWrapper pack(v8::Isolate* isolate, const knx_ldata& value) {
-			ObjectWrapper wrapper(isolate);
+	// Runs on the worker thread if there is one, which must not read 'disposed'. Callers on the
+	// JavaScript thread check it themselves, events of a disposed wrapper are dropped by 'worker_wake'.
+	static
+	bool process_raw(TunnelWrapper* wrapper, const uint8_t* message, size_t message_size) {
+		if (wrapper->capture) wrapper->capture->append(uv_hrtime(), CAPTURE_INBOUND, message, message_size);
 
-			wrapper.set("priority",    (uint32_t) value.control1.priority);
-			wrapper.set("repeat",                 value.control1.repeat);
-			wrapper.set("systemBroadcast",        value.control1.system_broadcast);
-			wrapper.set("requestAck",             value.control1.request_ack);
-			wrapper.set("error",                  value.control1.error);
-			wrapper.set("addressType", (uint32_t) value.control2.address_type);
-			wrapper.set("hops",        (uint32_t) value.control2.hops);
+		bool accepted = knx_tunnel_process(&wrapper->tunnel, message, message_size);
+		wrapper->stats.received(message_size, accepted);
 
-			wrapper.set("source",      (uint32_t) value.source);
-			wrapper.set("destination", (uint32_t) value.destination);
+		return accepted;
+	}
 
-			wrapper.set("tpdu",                   value.tpdu);
+	// Bypasses the queue, hence not available while there is a worker
+	static
+	int32_t m_send(void* tunnel, Local<Value> frame) {
+		knx_cemi cemi;
+		if (!tunnel || ((TunnelWrapper*) tunnel)->worker || !unmarshal_argument(frame, cemi)) return -1;
 
-			return wrapper;
-		}
-	};
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+		return knx_tunnel_send(&wrapper->tunnel, &cemi);
+	}
 
-	template <>
-	struct ValueWrapper<knx_cemi> {
-		static
-		constexpr const char* TypeName = "CEMI";
+	static
+	bool push_frame(TunnelWrapper* wrapper, const knx_cemi& cemi) {
+		return wrapper->pacing ? wrapper->pacing->push(cemi) : wrapper->queue->push(cemi);
+	}
 
-		static inline
-		bool check(v8::Local<v8::Value> value) {
-			if (!ValueWrapper<ObjectWrapper>::check(value))
-				return false;
+	static
+	bool queue_send_frame(void* tunnel, Local<Value> frame) {
+		knx_cemi cemi;
+		if (!tunnel || !unmarshal_argument(frame, cemi)) return false;
 
-			ObjectWrapper wrapper = ValueWrapper<ObjectWrapper>::unpack(value);
-			return wrapper.expect<uint32_t>("service") && wrapper.expect<knx_ldata>("payload");
-		}
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+		if (!wrapper->worker) return push_frame(wrapper, cemi);
 
-		static inline
-		knx_cemi unpack(v8::Local<v8::Value> value) {
-			ObjectWrapper wrapper = ValueWrapper<ObjectWrapper>::unpack(value);
+		ProtocolMessage message;
+		message.kind = PROTOCOL_SEND;
 
-			knx_cemi cemi {
-				(knx_cemi_service) wrapper.get<uint32_t>("service"),
-				0, nullptr
-			};
+		return message.frame.store(cemi) && wrapper->worker->submit(message);
+	}
 
-			cemi.payload.ldata = wrapper.get<knx_ldata>("payload");
+	static
+	uint32_t queued(void* tunnel) {
+		if (!tunnel) return 0;
 
-			return cemi;
-		}
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+		if (wrapper->worker) return wrapper->worker->backlog;
 
-		static inline
-		ObjectWrapper pack(v8::Isolate* isolate, const knx_cemi& value) {
-			ObjectWrapper wrapper(isolate);
+		return wrapper->queue->frames.length + (wrapper->pacing ? wrapper->pacing->length() : 0);
+	}
 
-			wrapper.set("service", (uint32_t) value.service);
-			wrapper.set("payload", ValueWrapper<knx_ldata>::pack(isolate, value.payload.ldata));
+	// The scheduler has to be set up before the worker is started, as the worker owns it afterwards.
+	// The same goes for coalescing and the statistics of both.
+	static
+	bool set_pacing(void* tunnel, double rate, double burst) {
+		return tunnel && !((TunnelWrapper*) tunnel)->worker && ::set_pacing((TunnelWrapper*) tunnel, rate, burst);
+	}
 
-			return wrapper;
-		}
-	};
-}
+	static
+	Handle<Value> pacing_stats(void* tunnel) {
+		if (!tunnel || ((TunnelWrapper*) tunnel)->worker) return Null(Isolate::GetCurrent());
 
-struct RouterWrapper {
-	Persistent<Function> send;
-	Persistent<Function> recv;
-	knx_router router;
+		return ::pacing_stats((TunnelWrapper*) tunnel);
+	}
 
 	static
-	void* create(Local<Function> send, Local<Function> recv) {
-		Isolate* isolate = Isolate::GetCurrent();
+	void set_coalescing(void* tunnel, bool enable) {
+		if (!tunnel) return;
 
-		RouterWrapper* wrapper = new RouterWrapper {
-			{isolate, send},
-			{isolate, recv}
-		};
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+		if (wrapper->worker) return;
 
-		knx_router_set_send_handler(&wrapper->router, (knx_router_send_cb) &RouterWrapper::cb_send, wrapper);
-		knx_router_set_recv_handler(&wrapper->router, (knx_router_recv_cb) &RouterWrapper::cb_recv, wrapper);
+		wrapper->coalesce = enable;
 
-		return wrapper;
+		wrapper->queue->frames.set_coalescing(enable);
+		if (wrapper->pacing) wrapper->pacing->set_coalescing(enable);
 	}
 
+	// Bounds of the retransmission timeout in milliseconds and the number of retransmissions after
+	// which a frame is dropped
 	static
-	bool process(void* router, Buffer message) {
-		if (!router) return false;
+	bool set_retransmission(void* tunnel, double min_timeout, double max_timeout, uint32_t max_retries) {
+		if (!tunnel || min_timeout <= 0) return false;
 
-		RouterWrapper* wrapper = (RouterWrapper*) router;
-		return knx_router_process(&wrapper->router, (const uint8_t*) message.data, message.length);
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+		if (wrapper->worker) return false;
+
+		wrapper->queue->configure(min_timeout, max_timeout, max_retries);
+		wrapper->retransmit_timeout.store(wrapper->queue->rtt.timeout(), std::memory_order_relaxed);
+
+		return true;
 	}
 
 	static
-	void m_send(void* router, knx_cemi cemi) {
-		if (!router) return;
+	double coalesced(void* tunnel) {
+		if (!tunnel) return 0;
 
-		RouterWrapper* wrapper = (RouterWrapper*) router;
-		knx_router_send(&wrapper->router, &cemi);
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+		if (wrapper->worker) return 0;
+
+		return wrapper->queue->frames.coalesced + (wrapper->pacing ? wrapper->pacing->coalesced() : 0);
 	}
 
+	// The scheduler hands over one frame at a time, so urgent frames never queue up behind others
 	static
-	void dispose(void* router) {
-		if (router) delete (RouterWrapper*) router;
+	bool pacing_send(void* tunnel, const knx_cemi* frame) {
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+		return wrapper->queue->frames.length == 0 && wrapper->queue->push(*frame);
 	}
 
 	static
-	void cb_send(
-		const knx_router* router,
-		RouterWrapper*    wrapper,
-		const uint8_t*    message,
-		size_t            message_size
-	) {
-		v8::Isolate* isolate = Isolate::GetCurrent();
-		Local<Function> callback = Local<Function>::New(isolate, wrapper->send);
+	void pacing_timeout(void* tunnel) {
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
 
-		Local<Value> args[1] = {copy_buffer((const char*) message, message_size)};
-		callback->Call(isolate->GetCurrentContext(), Null(isolate), 1, args);
+		if (wrapper->worker) {
+			wrapper->pacing->pump();
+			return;
+		}
+
+		process_from_loop(wrapper, [=]() {
+			wrapper->pacing->pump();
+		});
 	}
 
 	static
-	void cb_recv(
-		const knx_router* router,
-		RouterWrapper*    wrapper,
-		const knx_cemi*   frame
-	) {
-		v8::Isolate* isolate = Isolate::GetCurrent();
-		Local<Function> callback = Local<Function>::New(isolate, wrapper->recv);
+	uint32_t drain_ring(Isolate* isolate, Local<Array> frames, uint32_t length, FrameRing& ring) {
+		Local<Context> context = isolate->GetCurrentContext();
 
-		Local<Value> args[1] = {ValueWrapper<knx_cemi>::pack(isolate, *frame)};
-		callback->Call(isolate->GetCurrentContext(), Null(isolate), 1, args);
-	}
-};
+		for (; ring.length > 0; ring.pop()) {
+			Local<Value> frame = ValueWrapper<knx_cemi>::pack(isolate, ring.front().cemi);
+			frames->Set(context, length++, frame).FromMaybe(false);
+		}
 
-struct TunnelWrapper {
-	Persistent<Function> state_change;
-	Persistent<Function> send;
-	Persistent<Function> recv;
-	Persistent<Function> ack;
-	knx_tunnel tunnel;
+		return length;
+	}
 
+	// Take every queued frame out of the tunnel, so they can be sent through another connection.
+	// Frames held by a worker stay there.
 	static
-	void* create(Local<Function> state_change, Local<Function> send, Local<Function> recv, Local<Function> ack) {
+	Handle<Value> drain(void* tunnel) {
 		Isolate* isolate = Isolate::GetCurrent();
+		Local<Array> frames = Array::New(isolate);
+		if (!tunnel || ((TunnelWrapper*) tunnel)->worker) return frames;
 
-		TunnelWrapper* wrapper = new TunnelWrapper {
-			{isolate, state_change},
-			{isolate, send},
-			{isolate, recv},
-			{isolate, ack}
-		};
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+		uint32_t length = drain_ring(isolate, frames, 0, wrapper->queue->frames);
 
-		knx_tunnel_init(&wrapper->tunnel);
-		knx_tunnel_set_send_handler(&wrapper->tunnel, (knx_tunnel_send_cb) &TunnelWrapper::cb_send, wrapper);
-		knx_tunnel_set_recv_handler(&wrapper->tunnel, (knx_tunnel_recv_cb) &TunnelWrapper::cb_recv, wrapper);
-		knx_tunnel_set_state_change_handler(&wrapper->tunnel, (knx_tunnel_state_change_cb) &TunnelWrapper::cb_state_change, wrapper);
-		knx_tunnel_set_ack_handler(&wrapper->tunnel, (knx_tunnel_ack_cb) &TunnelWrapper::cb_ack, wrapper);
+		wrapper->queue->reset();
+		wrapper->queue->kick();
 
-		return wrapper;
+		if (wrapper->pacing) {
+			while (PacingLane* lane = wrapper->pacing->next())
+				length = drain_ring(isolate, frames, length, lane->frames);
+		}
+
+		return frames;
 	}
 
 	static
-	void dispose(void* tunnel) {
-		if (tunnel) delete (TunnelWrapper*) tunnel;
+	int32_t queue_send(void* tunnel, const knx_cemi* frame) {
+		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+		return knx_tunnel_send(&wrapper->tunnel, frame);
 	}
 
 	static
-	void connect(void* tunnel) {
-		if (!tunnel) return;
-
+	bool queue_resend(void* tunnel, uint8_t seq_number, const knx_cemi* frame) {
 		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
-		knx_tunnel_connect(&wrapper->tunnel);
+		wrapper->stats.resends.fetch_add(1, std::memory_order_relaxed);
+		wrapper->retransmit_timeout.store(wrapper->queue->rtt.timeout(), std::memory_order_relaxed);
+
+		return knx_tunnel_resend(&wrapper->tunnel, seq_number, frame);
 	}
 
+	// A gateway which does not acknowledge a request any more has lost track of the connection,
+	// KNXnet/IP has the client disconnect then. The remaining frames are sent through a new one.
 	static
-	bool process(void* tunnel, Buffer message) {
-		if (!tunnel) return false;
-
+	void queue_abandon(void* tunnel, knx_addr destination) {
 		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
-		return knx_tunnel_process(&wrapper->tunnel, (const uint8_t*) message.data, message.length);
+		wrapper->abandoned.fetch_add(1, std::memory_order_relaxed);
+
+		wrapper->resync = true;
+		knx_tunnel_disconnect(&wrapper->tunnel);
+
+		if (!wrapper->worker) {
+			notify_abandon(wrapper, destination);
+			return;
+		}
+
+		update_backlog(wrapper);
+
+		ProtocolMessage message;
+		message.kind = PROTOCOL_ABANDON;
+		message.args[0] = destination;
+
+		wrapper->worker->emit(message);
 	}
 
 	static
-	int32_t m_send(void* tunnel, knx_cemi cemi) {
-		if (!tunnel) return -1;
+	void notify_abandon(TunnelWrapper* wrapper, uint32_t destination) {
+		ProtocolMessage event;
+		event.kind = PROTOCOL_ABANDON;
+		event.args[0] = destination;
+
+		if (defer_event(wrapper, event)) return;
+
+		v8::Isolate* isolate = wrapper->isolate;
+		Local<Function> callback = Local<Function>::New(isolate, wrapper->abandon);
+
+		Local<Value> args[1] = {pack<uint32_t>(isolate, destination)};
+		call_js(wrapper, callback, 1, args);
+	}
 
+	static
+	void queue_timeout(void* tunnel) {
 		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
-		return knx_tunnel_send(&wrapper->tunnel, &cemi);
+
+		if (wrapper->worker) {
+			wrapper->queue->retransmit();
+			return;
+		}
+
+		process_from_loop(wrapper, [=]() {
+			wrapper->queue->retransmit();
+		});
 	}
 
 	static
-	bool resend(void* tunnel, uint32_t seq_no, knx_cemi cemi) {
-		if (!tunnel) return false;
+	bool resend(void* tunnel, uint32_t seq_no, Local<Value> frame) {
+		knx_cemi cemi;
+		if (!tunnel || ((TunnelWrapper*) tunnel)->worker || !unmarshal_argument(frame, cemi)) return false;
 
 		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
+		wrapper->stats.resends.fetch_add(1, std::memory_order_relaxed);
+
 		return knx_tunnel_resend(&wrapper->tunnel, seq_no, &cemi);
 	}
 
@@ -380,7 +2399,11 @@ struct TunnelWrapper {
 		if (!tunnel) return;
 
 		TunnelWrapper* wrapper = (TunnelWrapper*) tunnel;
-		knx_tunnel_disconnect(&wrapper->tunnel);
+
+		if (wrapper->worker)
+			submit(wrapper, PROTOCOL_DISCONNECT);
+		else
+			knx_tunnel_disconnect(&wrapper->tunnel);
 	}
 
 	static
@@ -390,11 +2413,19 @@ struct TunnelWrapper {
 		const uint8_t*    message,
 		size_t            message_size
 	) {
-		v8::Isolate* isolate = Isolate::GetCurrent();
+		wrapper->stats.sent(message_size);
+		if (wrapper->capture) wrapper->capture->append(uv_hrtime(), CAPTURE_OUTBOUND, message, message_size);
+
+		if (wrapper->transport) {
+			wrapper->transport->send(message, message_size);
+			return;
+		}
+
+		v8::Isolate* isolate = wrapper->isolate;
 		Local<Function> callback = Local<Function>::New(isolate, wrapper->send);
 
 		Local<Value> args[1] = {copy_buffer((const char*) message, message_size)};
-		callback->Call(isolate->GetCurrentContext(), Null(isolate), 1, args);
+		call_js(wrapper, callback, 1, args);
 	}
 
 	static
@@ -403,11 +2434,32 @@ struct TunnelWrapper {
 		TunnelWrapper*    wrapper,
 		const knx_cemi*   frame
 	) {
-		v8::Isolate* isolate = Isolate::GetCurrent();
+		wrapper->stats.frames_decoded.fetch_add(1, std::memory_order_relaxed);
+
+		if (!wrapper->worker) {
+			deliver(wrapper, frame);
+			return;
+		}
+
+		ProtocolMessage message;
+		message.kind = PROTOCOL_RECV;
+
+		if (message.frame.store(*frame))
+			wrapper->worker->emit(message);
+	}
+
+	static
+	void deliver(TunnelWrapper* wrapper, const knx_cemi* frame) {
+		wrapper->cache.update(*frame);
+		if (!accept_frame(wrapper, frame)) return;
+
+		v8::Isolate* isolate = wrapper->isolate;
+		if (collect_frame(isolate, wrapper, frame) || defer_frame(wrapper, frame)) return;
+
 		Local<Function> callback = Local<Function>::New(isolate, wrapper->recv);
 
-		Local<Value> args[1] = {ValueWrapper<knx_cemi>::pack(isolate, *frame)};
-		callback->Call(isolate->GetCurrentContext(), Null(isolate), 1, args);
+		Local<Value> args[1] = {pack_frame(isolate, wrapper, frame)};
+		call_js(wrapper, callback, 1, args);
 	}
 
 	static
@@ -415,11 +2467,44 @@ struct TunnelWrapper {
 		const knx_tunnel* tunnel,
 		TunnelWrapper*    wrapper
 	) {
-		v8::Isolate* isolate = Isolate::GetCurrent();
+		// Sequence numbers start over with every connection
+		if (tunnel->state == KNX_TUNNEL_CONNECTED) {
+			wrapper->queue->kick();
+			if (wrapper->pacing) wrapper->pacing->pump();
+		} else {
+			wrapper->queue->reset();
+		}
+
+		if (tunnel->state == KNX_TUNNEL_DISCONNECTED && wrapper->resync) {
+			wrapper->resync = false;
+			knx_tunnel_connect(&wrapper->tunnel);
+		}
+
+		if (!wrapper->worker) {
+			notify_state_change(wrapper, tunnel->state);
+			return;
+		}
+
+		ProtocolMessage message;
+		message.kind = PROTOCOL_STATE_CHANGE;
+		message.args[0] = tunnel->state;
+
+		wrapper->worker->emit(message);
+	}
+
+	static
+	void notify_state_change(TunnelWrapper* wrapper, uint32_t state) {
+		ProtocolMessage event;
+		event.kind = PROTOCOL_STATE_CHANGE;
+		event.args[0] = state;
+
+		if (defer_event(wrapper, event)) return;
+
+		v8::Isolate* isolate = wrapper->isolate;
 		Local<Function> callback = Local<Function>::New(isolate, wrapper->state_change);
 
-		Local<Value> args[1] = {pack<uint32_t>(isolate, tunnel->state)};
-		callback->Call(isolate->GetCurrentContext(), Null(isolate), 1, args);
+		Local<Value> args[1] = {pack<uint32_t>(isolate, state)};
+		call_js(wrapper, callback, 1, args);
 	}
 
 	static
@@ -428,19 +2513,81 @@ struct TunnelWrapper {
 		TunnelWrapper*    wrapper,
 		uint8_t           seq_number
 	) {
-		v8::Isolate* isolate = Isolate::GetCurrent();
+		OutboundQueue* queue = wrapper->queue;
+		uint32_t destination = queue->frames.length > 0 ? queue->frames.front().cemi.payload.ldata.destination : 0;
+
+		// Acknowledgements for frames that are no longer queued are of no interest
+		if (!queue->ack(seq_number))
+			return;
+
+		wrapper->ack_latency.record(queue->last_rtt);
+		wrapper->retransmit_timeout.store(queue->rtt.timeout(), std::memory_order_relaxed);
+
+		if (wrapper->pacing) wrapper->pacing->pump();
+
+		if (!wrapper->worker) {
+			notify_ack(wrapper, seq_number, destination);
+			return;
+		}
+
+		update_backlog(wrapper);
+
+		ProtocolMessage message;
+		message.kind = PROTOCOL_ACK;
+		message.args[0] = seq_number;
+		message.args[1] = destination;
+
+		wrapper->worker->emit(message);
+	}
+
+	static
+	void notify_ack(TunnelWrapper* wrapper, uint32_t seq_number, uint32_t destination) {
+		ProtocolMessage event;
+		event.kind = PROTOCOL_ACK;
+		event.args[0] = seq_number;
+		event.args[1] = destination;
+
+		if (defer_event(wrapper, event)) return;
+
+		v8::Isolate* isolate = wrapper->isolate;
 		Local<Function> callback = Local<Function>::New(isolate, wrapper->ack);
 
-		Local<Value> args[1] = {pack<uint32_t>(isolate, seq_number)};
-		callback->Call(isolate->GetCurrentContext(), Null(isolate), 1, args);
+		Local<Value> args[2] = {
+			pack<uint32_t>(isolate, seq_number),
+			pack<uint32_t>(isolate, destination)
+		};
+		call_js(wrapper, callback, 2, args);
 	}
 };
 
 static
-void knxproto_init(Handle<Object> module) {
-	Isolate* isolate = Isolate::GetCurrent();
+void knxproto_init_state(Isolate* isolate) {
+	// The module may be loaded into several contexts of the same isolate
+	if (addon_state) return;
+
+	addon_state = new AddonState;
+	addon_state->isolate = isolate;
+	addon_state->loop = node::GetCurrentEventLoop(isolate);
+
+	frame_shapes_init(isolate, addon_state->shapes);
+	stats_shapes_init(isolate, addon_state->stats);
+
+	// Registered before any wrapper, hence run after their hooks
+	node::AddEnvironmentCleanupHook(isolate, [](void* state) {
+		delete (AddonState*) state;
+		addon_state = nullptr;
+
+		knxproto_pool_close();
+	}, addon_state);
+}
+
+static
+void knxproto_init(Handle<Object> module, Handle<Value>, Handle<Context> context, void*) {
+	Isolate* isolate = context->GetIsolate();
 	ObjectWrapper module_wrapper(isolate, module);
 
+	knxproto_init_state(isolate);
+
 	// Constants
 	module_wrapper.set("LDataRequest",           (uint32_t) KNX_CEMI_LDATA_REQ);
 	module_wrapper.set("LDataConfirmation",      (uint32_t) KNX_CEMI_LDATA_CON);
@@ -468,52 +2615,159 @@ void knxproto_init(Handle<Object> module) {
 	module_wrapper.set("Restart",                (uint32_t) KNX_APCI_RESTART);
 	module_wrapper.set("Escape",                 (uint32_t) KNX_APCI_ESCAPE);
 
+	module_wrapper.set("PrioritySystem",         (uint32_t) KNX_LDATA_PRIO_SYSTEM);
+	module_wrapper.set("PriorityNormal",         (uint32_t) KNX_LDATA_PRIO_NORMAL);
+	module_wrapper.set("PriorityUrgent",         (uint32_t) KNX_LDATA_PRIO_URGENT);
+	module_wrapper.set("PriorityLow",            (uint32_t) KNX_LDATA_PRIO_LOW);
+
+	module_wrapper.set("DptUnsigned8",           (uint32_t) KNX_DPT_UNSIGNED8);
+	module_wrapper.set("DptUnsigned16",          (uint32_t) KNX_DPT_UNSIGNED16);
+	module_wrapper.set("DptUnsigned32",          (uint32_t) KNX_DPT_UNSIGNED32);
+	module_wrapper.set("DptSigned8",             (uint32_t) KNX_DPT_SIGNED8);
+	module_wrapper.set("DptSigned16",            (uint32_t) KNX_DPT_SIGNED16);
+	module_wrapper.set("DptSigned32",            (uint32_t) KNX_DPT_SIGNED32);
+	module_wrapper.set("DptFloat16",             (uint32_t) KNX_DPT_FLOAT16);
+	module_wrapper.set("DptFloat32",             (uint32_t) KNX_DPT_FLOAT32);
+	module_wrapper.set("DptBool",                (uint32_t) KNX_DPT_BOOL);
+	module_wrapper.set("DptChar",                (uint32_t) KNX_DPT_CHAR);
+	module_wrapper.set("DptCValue",              (uint32_t) KNX_DPT_CVALUE);
+	module_wrapper.set("DptCStep",               (uint32_t) KNX_DPT_CSTEP);
+	module_wrapper.set("DptTimeOfDay",           (uint32_t) KNX_DPT_TIMEOFDAY);
+	module_wrapper.set("DptDate",                (uint32_t) KNX_DPT_DATE);
+
+	// Validation of outgoing frames
+	module_wrapper.set("frameError", JAWRA_WRAP_FUNCTION(knxproto_frame_error));
+
 	// Router
-	module_wrapper.set("createRouter",  JAWRA_WRAP_FUNCTION(RouterWrapper::create));
-	module_wrapper.set("disposeRouter", JAWRA_WRAP_FUNCTION(RouterWrapper::dispose));
-	module_wrapper.set("processRouter", JAWRA_WRAP_FUNCTION(RouterWrapper::process));
-	module_wrapper.set("sendRouter",    JAWRA_WRAP_FUNCTION(RouterWrapper::m_send));
+	module_wrapper.set("createRouter",           JAWRA_WRAP_FUNCTION(RouterWrapper::create));
+	module_wrapper.set("disposeRouter",          JAWRA_WRAP_FUNCTION(RouterWrapper::dispose));
+	module_wrapper.set("openRouter",             JAWRA_WRAP_FUNCTION(RouterWrapper::open));
+	module_wrapper.set("processRouter",          JAWRA_WRAP_FUNCTION(RouterWrapper::process));
+	module_wrapper.set("processRouterBatch",     JAWRA_WRAP_FUNCTION(RouterWrapper::process_batch));
+	module_wrapper.set("enableRouterColumns",    JAWRA_WRAP_FUNCTION(RouterWrapper::enable_columns));
+	module_wrapper.set("processRouterColumns",   JAWRA_WRAP_FUNCTION(RouterWrapper::process_columns));
+	module_wrapper.set("sendRouter",             JAWRA_WRAP_FUNCTION(RouterWrapper::m_send));
+	module_wrapper.set("setRouterPacing",        JAWRA_WRAP_FUNCTION(RouterWrapper::set_pacing));
+	module_wrapper.set("routerPacingStats",      JAWRA_WRAP_FUNCTION(RouterWrapper::pacing_stats));
+	module_wrapper.set("setRouterCoalescing",    JAWRA_WRAP_FUNCTION(RouterWrapper::set_coalescing));
+	module_wrapper.set("coalescedRouter",        JAWRA_WRAP_FUNCTION(RouterWrapper::coalesced));
+	module_wrapper.set("enableRouterDelivery",   JAWRA_WRAP_FUNCTION(RouterWrapper::enable_delivery));
+	module_wrapper.set("disableRouterDelivery",  JAWRA_WRAP_FUNCTION(RouterWrapper::disable_delivery));
+	module_wrapper.set("setRouterZeroCopy",      JAWRA_WRAP_FUNCTION(RouterWrapper::set_zero_copy));
+	module_wrapper.set("subscribeRouter",        JAWRA_WRAP_FUNCTION(RouterWrapper::subscribe));
+	module_wrapper.set("unsubscribeRouter",      JAWRA_WRAP_FUNCTION(RouterWrapper::unsubscribe));
+	module_wrapper.set("filteredRouter",         JAWRA_WRAP_FUNCTION(RouterWrapper::filtered));
+	module_wrapper.set("lookupRouter",           JAWRA_WRAP_FUNCTION(RouterWrapper::lookup));
+	module_wrapper.set("snapshotRouter",         JAWRA_WRAP_FUNCTION(RouterWrapper::snapshot));
+	module_wrapper.set("registerRouterDpt",      JAWRA_WRAP_FUNCTION(RouterWrapper::register_dpt));
+	module_wrapper.set("unregisterRouterDpt",    JAWRA_WRAP_FUNCTION(RouterWrapper::unregister_dpt));
+	module_wrapper.set("routerStats",            JAWRA_WRAP_FUNCTION(RouterWrapper::get_stats));
+	module_wrapper.set("setRouterStatsInterval", JAWRA_WRAP_FUNCTION(RouterWrapper::set_stats_interval));
+	module_wrapper.set("startRouterCapture",     JAWRA_WRAP_FUNCTION(RouterWrapper::start_capture));
+	module_wrapper.set("stopRouterCapture",      JAWRA_WRAP_FUNCTION(RouterWrapper::stop_capture));
+	module_wrapper.set("replayRouter",           JAWRA_WRAP_FUNCTION(RouterWrapper::replay));
+	module_wrapper.set("stopRouterReplay",       JAWRA_WRAP_FUNCTION(RouterWrapper::stop_replay));
 
 	// Tunnel
-	module_wrapper.set("createTunnel",     JAWRA_WRAP_FUNCTION(TunnelWrapper::create));
-	module_wrapper.set("disposeTunnel",    JAWRA_WRAP_FUNCTION(TunnelWrapper::dispose));
-	module_wrapper.set("connectTunnel",    JAWRA_WRAP_FUNCTION(TunnelWrapper::connect));
-	module_wrapper.set("disconnectTunnel", JAWRA_WRAP_FUNCTION(TunnelWrapper::disconnect));
-	module_wrapper.set("processTunnel",    JAWRA_WRAP_FUNCTION(TunnelWrapper::process));
-	module_wrapper.set("sendTunnel",       JAWRA_WRAP_FUNCTION(TunnelWrapper::m_send));
-	module_wrapper.set("resendTunnel",     JAWRA_WRAP_FUNCTION(TunnelWrapper::resend));
+	module_wrapper.set("createTunnel",           JAWRA_WRAP_FUNCTION(TunnelWrapper::create));
+	module_wrapper.set("disposeTunnel",          JAWRA_WRAP_FUNCTION(TunnelWrapper::dispose));
+	module_wrapper.set("openTunnel",             JAWRA_WRAP_FUNCTION(TunnelWrapper::open));
+	module_wrapper.set("startTunnelWorker",      JAWRA_WRAP_FUNCTION(TunnelWrapper::start_worker));
+	module_wrapper.set("connectTunnel",          JAWRA_WRAP_FUNCTION(TunnelWrapper::connect));
+	module_wrapper.set("disconnectTunnel",       JAWRA_WRAP_FUNCTION(TunnelWrapper::disconnect));
+	module_wrapper.set("processTunnel",          JAWRA_WRAP_FUNCTION(TunnelWrapper::process));
+	module_wrapper.set("processTunnelBatch",     JAWRA_WRAP_FUNCTION(TunnelWrapper::process_batch));
+	module_wrapper.set("enableTunnelColumns",    JAWRA_WRAP_FUNCTION(TunnelWrapper::enable_columns));
+	module_wrapper.set("processTunnelColumns",   JAWRA_WRAP_FUNCTION(TunnelWrapper::process_columns));
+	module_wrapper.set("sendTunnel",             JAWRA_WRAP_FUNCTION(TunnelWrapper::m_send));
+	module_wrapper.set("resendTunnel",           JAWRA_WRAP_FUNCTION(TunnelWrapper::resend));
+	module_wrapper.set("queueTunnel",            JAWRA_WRAP_FUNCTION(TunnelWrapper::queue_send_frame));
+	module_wrapper.set("drainTunnel",            JAWRA_WRAP_FUNCTION(TunnelWrapper::drain));
+	module_wrapper.set("queuedTunnel",           JAWRA_WRAP_FUNCTION(TunnelWrapper::queued));
+	module_wrapper.set("setTunnelPacing",        JAWRA_WRAP_FUNCTION(TunnelWrapper::set_pacing));
+	module_wrapper.set("tunnelPacingStats",      JAWRA_WRAP_FUNCTION(TunnelWrapper::pacing_stats));
+	module_wrapper.set("setTunnelCoalescing",    JAWRA_WRAP_FUNCTION(TunnelWrapper::set_coalescing));
+	module_wrapper.set("setTunnelRetransmit",    JAWRA_WRAP_FUNCTION(TunnelWrapper::set_retransmission));
+	module_wrapper.set("coalescedTunnel",        JAWRA_WRAP_FUNCTION(TunnelWrapper::coalesced));
+	module_wrapper.set("enableTunnelDelivery",   JAWRA_WRAP_FUNCTION(TunnelWrapper::enable_delivery));
+	module_wrapper.set("disableTunnelDelivery",  JAWRA_WRAP_FUNCTION(TunnelWrapper::disable_delivery));
+	module_wrapper.set("setTunnelZeroCopy",      JAWRA_WRAP_FUNCTION(TunnelWrapper::set_zero_copy));
+	module_wrapper.set("subscribeTunnel",        JAWRA_WRAP_FUNCTION(TunnelWrapper::subscribe));
+	module_wrapper.set("unsubscribeTunnel",      JAWRA_WRAP_FUNCTION(TunnelWrapper::unsubscribe));
+	module_wrapper.set("filteredTunnel",         JAWRA_WRAP_FUNCTION(TunnelWrapper::filtered));
+	module_wrapper.set("lookupTunnel",           JAWRA_WRAP_FUNCTION(TunnelWrapper::lookup));
+	module_wrapper.set("snapshotTunnel",         JAWRA_WRAP_FUNCTION(TunnelWrapper::snapshot));
+	module_wrapper.set("registerTunnelDpt",      JAWRA_WRAP_FUNCTION(TunnelWrapper::register_dpt));
+	module_wrapper.set("unregisterTunnelDpt",    JAWRA_WRAP_FUNCTION(TunnelWrapper::unregister_dpt));
+	module_wrapper.set("tunnelStats",            JAWRA_WRAP_FUNCTION(TunnelWrapper::get_stats));
+	module_wrapper.set("setTunnelStatsInterval", JAWRA_WRAP_FUNCTION(TunnelWrapper::set_stats_interval));
+	module_wrapper.set("startTunnelCapture",     JAWRA_WRAP_FUNCTION(TunnelWrapper::start_capture));
+	module_wrapper.set("stopTunnelCapture",      JAWRA_WRAP_FUNCTION(TunnelWrapper::stop_capture));
 
 	// Parsers
-	module_wrapper.set("unpackUnsigned8",  JAWRA_WRAP_FUNCTION(knxproto_parse_unsigned8));
-	module_wrapper.set("unpackUnsigned16", JAWRA_WRAP_FUNCTION(knxproto_parse_unsigned16));
-	module_wrapper.set("unpackUnsigned32", JAWRA_WRAP_FUNCTION(knxproto_parse_unsigned32));
-	module_wrapper.set("unpackSigned8",    JAWRA_WRAP_FUNCTION(knxproto_parse_signed8));
-	module_wrapper.set("unpackSigned16",   JAWRA_WRAP_FUNCTION(knxproto_parse_signed16));
-	module_wrapper.set("unpackSigned32",   JAWRA_WRAP_FUNCTION(knxproto_parse_signed32));
-	module_wrapper.set("unpackFloat16",    JAWRA_WRAP_FUNCTION(knxproto_parse_float16));
-	module_wrapper.set("unpackFloat32",    JAWRA_WRAP_FUNCTION(knxproto_parse_float32));
-	module_wrapper.set("unpackBool",       JAWRA_WRAP_FUNCTION(knxproto_parse_bool));
-	module_wrapper.set("unpackChar",       JAWRA_WRAP_FUNCTION(knxproto_parse_char));
-	module_wrapper.set("unpackCValue",     JAWRA_WRAP_FUNCTION(knxproto_parse_cvalue));
-	module_wrapper.set("unpackCStep",      JAWRA_WRAP_FUNCTION(knxproto_parse_cstep));
-	module_wrapper.set("unpackTimeOfDay",  JAWRA_WRAP_FUNCTION(knxproto_parse_timeofday));
-	module_wrapper.set("unpackDate",       JAWRA_WRAP_FUNCTION(knxproto_parse_date));
+	module_wrapper.set("unpackUnsigned8",  JAWRA_WRAP_FUNCTION(knxproto_parse_type<KNX_DPT_UNSIGNED8>));
+	module_wrapper.set("unpackUnsigned16", JAWRA_WRAP_FUNCTION(knxproto_parse_type<KNX_DPT_UNSIGNED16>));
+	module_wrapper.set("unpackUnsigned32", JAWRA_WRAP_FUNCTION(knxproto_parse_type<KNX_DPT_UNSIGNED32>));
+	module_wrapper.set("unpackSigned8",    JAWRA_WRAP_FUNCTION(knxproto_parse_type<KNX_DPT_SIGNED8>));
+	module_wrapper.set("unpackSigned16",   JAWRA_WRAP_FUNCTION(knxproto_parse_type<KNX_DPT_SIGNED16>));
+	module_wrapper.set("unpackSigned32",   JAWRA_WRAP_FUNCTION(knxproto_parse_type<KNX_DPT_SIGNED32>));
+	module_wrapper.set("unpackFloat16",    JAWRA_WRAP_FUNCTION(knxproto_parse_type<KNX_DPT_FLOAT16>));
+	module_wrapper.set("unpackFloat32",    JAWRA_WRAP_FUNCTION(knxproto_parse_type<KNX_DPT_FLOAT32>));
+	module_wrapper.set("unpackBool",       JAWRA_WRAP_FUNCTION(knxproto_parse_type<KNX_DPT_BOOL>));
+	module_wrapper.set("unpackChar",       JAWRA_WRAP_FUNCTION(knxproto_parse_type<KNX_DPT_CHAR>));
+	module_wrapper.set("unpackCValue",     JAWRA_WRAP_FUNCTION(knxproto_parse_type<KNX_DPT_CVALUE>));
+	module_wrapper.set("unpackCStep",      JAWRA_WRAP_FUNCTION(knxproto_parse_type<KNX_DPT_CSTEP>));
+	module_wrapper.set("unpackTimeOfDay",  JAWRA_WRAP_FUNCTION(knxproto_parse_type<KNX_DPT_TIMEOFDAY>));
+	module_wrapper.set("unpackDate",       JAWRA_WRAP_FUNCTION(knxproto_parse_type<KNX_DPT_DATE>));
 
 	// Generators
-	module_wrapper.set("packUnsigned8",  JAWRA_WRAP_FUNCTION(knxproto_make_unsigned8));
-	module_wrapper.set("packUnsigned16", JAWRA_WRAP_FUNCTION(knxproto_make_unsigned16));
-	module_wrapper.set("packUnsigned32", JAWRA_WRAP_FUNCTION(knxproto_make_unsigned32));
-	module_wrapper.set("packSigned8",    JAWRA_WRAP_FUNCTION(knxproto_make_signed8));
-	module_wrapper.set("packSigned16",   JAWRA_WRAP_FUNCTION(knxproto_make_signed16));
-	module_wrapper.set("packSigned32",   JAWRA_WRAP_FUNCTION(knxproto_make_signed32));
-	module_wrapper.set("packFloat16",    JAWRA_WRAP_FUNCTION(knxproto_make_float16));
-	module_wrapper.set("packFloat32",    JAWRA_WRAP_FUNCTION(knxproto_make_float32));
-	module_wrapper.set("packBool",       JAWRA_WRAP_FUNCTION(knxproto_make_bool));
-	module_wrapper.set("packChar",       JAWRA_WRAP_FUNCTION(knxproto_make_char));
-	module_wrapper.set("packCValue",     JAWRA_WRAP_FUNCTION(knxproto_make_cvalue));
-	module_wrapper.set("packCStep",      JAWRA_WRAP_FUNCTION(knxproto_make_cstep));
-	module_wrapper.set("packTimeOfDay",  JAWRA_WRAP_FUNCTION(knxproto_make_timeofday));
-	module_wrapper.set("packDate",       JAWRA_WRAP_FUNCTION(knxproto_make_date));
-}
-
-NODE_MODULE(knxproto, knxproto_init)
+	module_wrapper.set("packUnsigned8",  JAWRA_WRAP_FUNCTION(knxproto_make_type<KNX_DPT_UNSIGNED8>));
+	module_wrapper.set("packUnsigned16", JAWRA_WRAP_FUNCTION(knxproto_make_type<KNX_DPT_UNSIGNED16>));
+	module_wrapper.set("packUnsigned32", JAWRA_WRAP_FUNCTION(knxproto_make_type<KNX_DPT_UNSIGNED32>));
+	module_wrapper.set("packSigned8",    JAWRA_WRAP_FUNCTION(knxproto_make_type<KNX_DPT_SIGNED8>));
+	module_wrapper.set("packSigned16",   JAWRA_WRAP_FUNCTION(knxproto_make_type<KNX_DPT_SIGNED16>));
+	module_wrapper.set("packSigned32",   JAWRA_WRAP_FUNCTION(knxproto_make_type<KNX_DPT_SIGNED32>));
+	module_wrapper.set("packFloat16",    JAWRA_WRAP_FUNCTION(knxproto_make_type<KNX_DPT_FLOAT16>));
+	module_wrapper.set("packFloat32",    JAWRA_WRAP_FUNCTION(knxproto_make_type<KNX_DPT_FLOAT32>));
+	module_wrapper.set("packBool",       JAWRA_WRAP_FUNCTION(knxproto_make_type<KNX_DPT_BOOL>));
+	module_wrapper.set("packChar",       JAWRA_WRAP_FUNCTION(knxproto_make_type<KNX_DPT_CHAR>));
+	module_wrapper.set("packCValue",     JAWRA_WRAP_FUNCTION(knxproto_make_type<KNX_DPT_CVALUE>));
+	module_wrapper.set("packCStep",      JAWRA_WRAP_FUNCTION(knxproto_make_type<KNX_DPT_CSTEP>));
+	module_wrapper.set("packTimeOfDay",  JAWRA_WRAP_FUNCTION(knxproto_make_type<KNX_DPT_TIMEOFDAY>));
+	module_wrapper.set("packDate",       JAWRA_WRAP_FUNCTION(knxproto_make_type<KNX_DPT_DATE>));
+
+	// Generators writing into an existing Buffer
+	module_wrapper.set("packUnsigned8Into",  JAWRA_WRAP_FUNCTION(knxproto_make_type_into<KNX_DPT_UNSIGNED8>));
+	module_wrapper.set("packUnsigned16Into", JAWRA_WRAP_FUNCTION(knxproto_make_type_into<KNX_DPT_UNSIGNED16>));
+	module_wrapper.set("packUnsigned32Into", JAWRA_WRAP_FUNCTION(knxproto_make_type_into<KNX_DPT_UNSIGNED32>));
+	module_wrapper.set("packSigned8Into",    JAWRA_WRAP_FUNCTION(knxproto_make_type_into<KNX_DPT_SIGNED8>));
+	module_wrapper.set("packSigned16Into",   JAWRA_WRAP_FUNCTION(knxproto_make_type_into<KNX_DPT_SIGNED16>));
+	module_wrapper.set("packSigned32Into",   JAWRA_WRAP_FUNCTION(knxproto_make_type_into<KNX_DPT_SIGNED32>));
+	module_wrapper.set("packFloat16Into",    JAWRA_WRAP_FUNCTION(knxproto_make_type_into<KNX_DPT_FLOAT16>));
+	module_wrapper.set("packFloat32Into",    JAWRA_WRAP_FUNCTION(knxproto_make_type_into<KNX_DPT_FLOAT32>));
+	module_wrapper.set("packBoolInto",       JAWRA_WRAP_FUNCTION(knxproto_make_type_into<KNX_DPT_BOOL>));
+	module_wrapper.set("packCharInto",       JAWRA_WRAP_FUNCTION(knxproto_make_type_into<KNX_DPT_CHAR>));
+	module_wrapper.set("packCValueInto",     JAWRA_WRAP_FUNCTION(knxproto_make_type_into<KNX_DPT_CVALUE>));
+	module_wrapper.set("packCStepInto",      JAWRA_WRAP_FUNCTION(knxproto_make_type_into<KNX_DPT_CSTEP>));
+	module_wrapper.set("packTimeOfDayInto",  JAWRA_WRAP_FUNCTION(knxproto_make_type_into<KNX_DPT_TIMEOFDAY>));
+	module_wrapper.set("packDateInto",       JAWRA_WRAP_FUNCTION(knxproto_make_type_into<KNX_DPT_DATE>));
+
+	// Generic parser and generator, dispatching on the DPT identifier
+	module_wrapper.set("unpack",   JAWRA_WRAP_FUNCTION(knxproto_unpack_dpt));
+	module_wrapper.set("pack",     JAWRA_WRAP_FUNCTION(knxproto_pack_dpt));
+	module_wrapper.set("packInto", JAWRA_WRAP_FUNCTION(knxproto_pack_dpt_into));
+
+	// Bulk parsers and generators
+	module_wrapper.set("unpackFloat16Array",    JAWRA_WRAP_FUNCTION(knxproto_parse_float16_array));
+	module_wrapper.set("unpackFloat32Array",    JAWRA_WRAP_FUNCTION(knxproto_parse_float32_array));
+	module_wrapper.set("unpackUnsigned16Array", JAWRA_WRAP_FUNCTION(knxproto_parse_unsigned16_array));
+
+	module_wrapper.set("packFloat16Array",    JAWRA_WRAP_FUNCTION(knxproto_make_float16_array));
+	module_wrapper.set("packFloat32Array",    JAWRA_WRAP_FUNCTION(knxproto_make_float32_array));
+	module_wrapper.set("packUnsigned16Array", JAWRA_WRAP_FUNCTION(knxproto_make_unsigned16_array));
+
+	// Buffer pool
+	module_wrapper.set("getBufferPoolStats", JAWRA_WRAP_FUNCTION(knxproto_buffer_pool_stats));
+}
+
+NODE_MODULE_CONTEXT_AWARE(knxproto, knxproto_init)
@@ -0,0 +1,32 @@
+#ifndef KNXPROTO_LIB_MESSAGE_H_
+#define KNXPROTO_LIB_MESSAGE_H_
+
+#include "queue.hpp"
+
+#include <cstdint>
+
+enum ProtocolMessageKind: uint8_t {
+	// Commands for a worker
+	PROTOCOL_SEND,
+	PROTOCOL_CONNECT,
+	PROTOCOL_DISCONNECT,
+
+	// Events for JavaScript
+	PROTOCOL_RECV,
+	PROTOCOL_STATE_CHANGE,
+	PROTOCOL_ACK,
+	PROTOCOL_ABANDON
+};
+
+// Self-contained command or event, which may be kept around or passed between threads
+struct ProtocolMessage {
+	ProtocolMessageKind kind;
+
+	// State, sequence number and destination of an acknowledged frame, or destination of an
+	// abandoned frame
+	uint32_t args[2];
+
+	QueuedFrame frame;
+};
+
+#endif
@@ -0,0 +1,145 @@
+#include "pool.hpp"
+
+struct PoolBlock {
+	PoolBlock* next;
+};
+
+static constexpr size_t pool_slab_size = 4096;
+
+// Slabs of a class are linked through a header in front of their blocks
+struct PoolSlab {
+	PoolSlab* next;
+	char data[pool_slab_size - sizeof(PoolSlab*)];
+};
+
+struct PoolClass {
+	size_t block_size;
+	PoolBlock* free_list;
+	PoolSlab* slabs;
+	knxproto_pool_class_stats stats;
+};
+
+// Buffers are allocated and finalized on the thread of the isolate they belong to, hence every
+// thread keeps a pool of its own
+static thread_local
+PoolClass pool_classes[knxproto_pool_classes] = {
+	{8,  nullptr, nullptr, {8}},
+	{16, nullptr, nullptr, {16}},
+	{32, nullptr, nullptr, {32}},
+	{64, nullptr, nullptr, {64}}
+};
+
+static thread_local uint64_t pool_heap_allocations = 0;
+static thread_local size_t pool_heap_in_use = 0;
+
+// Set once the pool has been closed, classes are freed as soon as their last buffer is released
+static thread_local bool pool_closing = false;
+
+static inline
+PoolClass* pool_find_class(size_t length) {
+	for (PoolClass& pool_class: pool_classes)
+		if (length <= pool_class.block_size)
+			return &pool_class;
+
+	return nullptr;
+}
+
+static
+void pool_grow(PoolClass* pool_class) {
+	// Slabs are kept until the pool is closed, it only grows to the peak number of live buffers
+	PoolSlab* slab = new PoolSlab;
+	size_t blocks = sizeof(slab->data) / pool_class->block_size;
+
+	slab->next = pool_class->slabs;
+	pool_class->slabs = slab;
+
+	for (size_t i = 0; i < blocks; i++) {
+		PoolBlock* block = (PoolBlock*) (slab->data + i * pool_class->block_size);
+		block->next = pool_class->free_list;
+		pool_class->free_list = block;
+	}
+
+	pool_class->stats.slabs++;
+	pool_class->stats.free += blocks;
+}
+
+// Frees the slabs of a class, unless some of its buffers are still alive
+static
+void pool_trim(PoolClass* pool_class) {
+	if (pool_class->stats.in_use > 0)
+		return;
+
+	while (PoolSlab* slab = pool_class->slabs) {
+		pool_class->slabs = slab->next;
+		delete slab;
+	}
+
+	pool_class->free_list = nullptr;
+	pool_class->stats.slabs = 0;
+	pool_class->stats.free = 0;
+}
+
+char* knxproto_pool_alloc(size_t length) {
+	PoolClass* pool_class = pool_find_class(length);
+
+	if (!pool_class) {
+		pool_heap_allocations++;
+		pool_heap_in_use++;
+
+		return new char[length];
+	}
+
+	if (pool_class->free_list)
+		pool_class->stats.reuses++;
+	else
+		pool_grow(pool_class);
+
+	PoolBlock* block = pool_class->free_list;
+	pool_class->free_list = block->next;
+
+	pool_class->stats.allocations++;
+	pool_class->stats.in_use++;
+	pool_class->stats.free--;
+
+	return (char*) block;
+}
+
+void knxproto_pool_release(char* buffer, size_t length) {
+	PoolClass* pool_class = pool_find_class(length);
+
+	if (!pool_class) {
+		pool_heap_in_use--;
+		delete[] buffer;
+
+		return;
+	}
+
+	PoolBlock* block = (PoolBlock*) buffer;
+	block->next = pool_class->free_list;
+	pool_class->free_list = block;
+
+	pool_class->stats.in_use--;
+	pool_class->stats.free++;
+
+	if (pool_closing)
+		pool_trim(pool_class);
+}
+
+void knxproto_pool_close() {
+	pool_closing = true;
+
+	for (PoolClass& pool_class: pool_classes)
+		pool_trim(&pool_class);
+}
+
+knxproto_pool_stats knxproto_pool_get_stats() {
+	knxproto_pool_stats stats;
+
+	for (size_t i = 0; i < knxproto_pool_classes; i++)
+		stats.classes[i] = pool_classes[i].stats;
+
+	stats.heap_allocations = pool_heap_allocations;
+	stats.heap_in_use = pool_heap_in_use;
+
+	return stats;
+}
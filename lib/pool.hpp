@@ -0,0 +1,38 @@
+#ifndef KNXPROTO_LIB_POOL_H_
+#define KNXPROTO_LIB_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Small buffers (up to 64 bytes) are carved from slabs kept per size class and recycled once their
+// owner is released. Larger requests fall back to the heap.
+
+constexpr size_t knxproto_pool_classes = 4;
+constexpr size_t knxproto_pool_max_size = 64;
+
+struct knxproto_pool_class_stats {
+	size_t block_size;
+	size_t slabs;
+	size_t in_use;
+	size_t free;
+	uint64_t allocations;
+	uint64_t reuses;
+};
+
+struct knxproto_pool_stats {
+	knxproto_pool_class_stats classes[knxproto_pool_classes];
+	uint64_t heap_allocations;
+	size_t heap_in_use;
+};
+
+char* knxproto_pool_alloc(size_t length);
+
+void knxproto_pool_release(char* buffer, size_t length);
+
+knxproto_pool_stats knxproto_pool_get_stats();
+
+// Free the slabs of the calling thread. Buffers which are still alive are fine to release later,
+// the slabs they belong to are freed once that has happened.
+void knxproto_pool_close();
+
+#endif
@@ -0,0 +1,315 @@
+#include "queue.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+static inline
+bool frame_has_data(const knx_cemi& frame) {
+	const knx_tpdu& tpdu = frame.payload.ldata.tpdu;
+	return tpdu.tpci == KNX_TPCI_UNNUMBERED_DATA || tpdu.tpci == KNX_TPCI_NUMBERED_DATA;
+}
+
+bool QueuedFrame::store(const knx_cemi& frame) {
+	const knx_tpdu& tpdu = frame.payload.ldata.tpdu;
+	bool has_data = frame_has_data(frame);
+
+	if (has_data && tpdu.info.data.length > sizeof(payload))
+		return false;
+
+	cemi = frame;
+
+	if (has_data)
+		std::copy(tpdu.info.data.payload, tpdu.info.data.payload + tpdu.info.data.length, payload);
+
+	return true;
+}
+
+knx_cemi& QueuedFrame::restore() {
+	if (frame_has_data(cemi))
+		cemi.payload.ldata.tpdu.info.data.payload = payload;
+
+	return cemi;
+}
+
+static inline
+bool frame_is_group_write(const knx_cemi& frame) {
+	const knx_ldata& ldata = frame.payload.ldata;
+
+	return ldata.control2.address_type == KNX_LDATA_ADDR_GROUP
+	    && ldata.tpdu.tpci == KNX_TPCI_UNNUMBERED_DATA
+	    && ldata.tpdu.info.data.apci == KNX_APCI_GROUPVALUEWRITE;
+}
+
+void FrameRing::init(size_t initial_capacity) {
+	capacity = initial_capacity;
+	slots = new QueuedFrame[capacity];
+	head = 0;
+	length = 0;
+
+	popped = 0;
+	writes = nullptr;
+	coalesced = 0;
+}
+
+void FrameRing::release() {
+	delete[] slots;
+	slots = nullptr;
+	length = 0;
+
+	delete writes;
+	writes = nullptr;
+}
+
+void FrameRing::set_coalescing(bool enable) {
+	if (!enable) {
+		delete writes;
+		writes = nullptr;
+	} else if (!writes) {
+		// Frames queued before now are not indexed and simply won't be replaced
+		writes = new std::unordered_map<uint16_t, uint64_t>;
+	}
+}
+
+bool FrameRing::push(const knx_cemi& frame) {
+	const knx_tpdu& tpdu = frame.payload.ldata.tpdu;
+
+	if (frame_has_data(frame) && tpdu.info.data.length > sizeof(QueuedFrame::payload))
+		return false;
+
+	bool group_write = writes && frame_is_group_write(frame);
+
+	if (group_write) {
+		auto it = writes->find(frame.payload.ldata.destination);
+
+		if (it != writes->end()) {
+			slots[(head + (it->second - popped)) % capacity].store(frame);
+			coalesced++;
+
+			return true;
+		}
+	}
+
+	// Grow by moving the queued frames to the start of a larger ring
+	if (length == capacity) {
+		QueuedFrame* grown = new QueuedFrame[capacity * 2];
+
+		for (size_t i = 0; i < length; i++)
+			grown[i] = slots[(head + i) % capacity];
+
+		delete[] slots;
+
+		slots = grown;
+		capacity *= 2;
+		head = 0;
+	}
+
+	slots[(head + length) % capacity].store(frame);
+
+	if (group_write)
+		(*writes)[frame.payload.ldata.destination] = popped + length;
+
+	length++;
+
+	return true;
+}
+
+QueuedFrame& FrameRing::front() {
+	QueuedFrame& slot = slots[head];
+	slot.restore();
+
+	return slot;
+}
+
+void FrameRing::seal_front() {
+	if (!writes || length == 0)
+		return;
+
+	auto it = writes->find(slots[head].cemi.payload.ldata.destination);
+	if (it != writes->end() && it->second == popped)
+		writes->erase(it);
+}
+
+void FrameRing::unseal_front() {
+	if (!writes || length == 0 || !frame_is_group_write(slots[head].cemi))
+		return;
+
+	writes->emplace(slots[head].cemi.payload.ldata.destination, popped);
+}
+
+void FrameRing::pop() {
+	seal_front();
+
+	head = (head + 1) % capacity;
+	length--;
+	popped++;
+}
+
+void RttEstimator::init(double initial, double min_rto, double max_rto) {
+	srtt = 0;
+	rttvar = 0;
+	measured = false;
+
+	this->min_rto = min_rto;
+	this->max_rto = max_rto;
+
+	rto = std::min(std::max(initial, min_rto), max_rto);
+}
+
+void RttEstimator::sample(double rtt) {
+	if (measured) {
+		rttvar = 0.75 * rttvar + 0.25 * std::fabs(srtt - rtt);
+		srtt = 0.875 * srtt + 0.125 * rtt;
+	} else {
+		srtt = rtt;
+		rttvar = rtt / 2;
+		measured = true;
+	}
+
+	rto = std::min(std::max(srtt + 4 * rttvar, min_rto), max_rto);
+}
+
+void RttEstimator::backoff() {
+	rto = std::min(rto * 2, max_rto);
+}
+
+uint64_t RttEstimator::timeout() const {
+	return (uint64_t) std::ceil(rto);
+}
+
+OutboundQueue* OutboundQueue::create(
+	const OutboundQueueHandlers& handlers,
+	void*                        data,
+	uint64_t                     interval,
+	uv_loop_t*                   loop
+) {
+	OutboundQueue* queue = new OutboundQueue;
+
+	queue->handlers = handlers;
+	queue->data = data;
+
+	queue->frames.init(64);
+
+	queue->in_flight = false;
+	queue->seq_number = 0;
+	queue->sent_at = 0;
+	queue->last_rtt = 0;
+	queue->retries = 0;
+	queue->interval = interval;
+
+	// KNXnet/IP expects an acknowledgement within a second and allows one repetition, a gateway
+	// far slower than that is treated as gone
+	queue->max_retries = 1;
+	queue->rtt.init(interval, 10, 4 * interval);
+
+	uv_timer_init(loop, &queue->timer);
+	queue->timer.data = queue;
+
+	return queue;
+}
+
+void OutboundQueue::configure(double min_rto, double max_rto, uint32_t max_retries) {
+	this->max_retries = max_retries;
+
+	rtt.min_rto = min_rto;
+	rtt.max_rto = std::max(min_rto, max_rto);
+	rtt.rto = std::min(std::max(rtt.rto, rtt.min_rto), rtt.max_rto);
+}
+
+bool OutboundQueue::push(const knx_cemi& frame) {
+	if (!frames.push(frame))
+		return false;
+
+	kick();
+
+	return true;
+}
+
+bool OutboundQueue::ack(uint8_t seq) {
+	if (!in_flight || seq != seq_number)
+		return false;
+
+	last_rtt = (uv_hrtime() - sent_at) / 1000;
+
+	// Acknowledgements of retransmitted frames are ambiguous, Karn's algorithm ignores them
+	if (retries == 0)
+		rtt.sample(last_rtt / 1000.0);
+
+	in_flight = false;
+	frames.pop();
+	kick();
+
+	return true;
+}
+
+void OutboundQueue::kick() {
+	if (!in_flight && frames.length > 0)
+		send_front();
+
+	if (frames.length == 0)
+		uv_timer_stop(&timer);
+}
+
+void OutboundQueue::reset() {
+	in_flight = false;
+}
+
+void OutboundQueue::retransmit() {
+	if (frames.length == 0)
+		return;
+
+	if (!in_flight) {
+		send_front();
+		return;
+	}
+
+	// The frame is gone before the handler runs, which is likely to disconnect and reset the queue
+	if (retries >= max_retries) {
+		knx_addr destination = frames.front().cemi.payload.ldata.destination;
+
+		in_flight = false;
+		frames.pop();
+
+		handlers.abandon(data, destination);
+		return;
+	}
+
+	retries++;
+	rtt.backoff();
+
+	handlers.resend(data, seq_number, &frames.front().cemi);
+	arm(rtt.timeout());
+}
+
+void OutboundQueue::close() {
+	frames.release();
+
+	uv_timer_stop(&timer);
+	uv_close((uv_handle_t*) &timer, [](uv_handle_t* handle) {
+		delete (OutboundQueue*) handle->data;
+	});
+}
+
+void OutboundQueue::send_front() {
+	frames.seal_front();
+
+	int32_t seq = handlers.send(data, &frames.front().cemi);
+
+	if (seq >= 0) {
+		in_flight = true;
+		seq_number = seq;
+		sent_at = uv_hrtime();
+		retries = 0;
+
+		arm(rtt.timeout());
+	} else {
+		// Without a sequence number the tunnel is not ready, the timer will try again
+		arm(interval);
+	}
+}
+
+void OutboundQueue::arm(uint64_t timeout) {
+	uv_timer_start(&timer, [](uv_timer_t* timer) {
+		OutboundQueue* queue = (OutboundQueue*) timer->data;
+		queue->handlers.timeout(queue->data);
+	}, timeout, 0);
+}
@@ -0,0 +1,169 @@
+#ifndef KNXPROTO_LIB_QUEUE_H_
+#define KNXPROTO_LIB_QUEUE_H_
+
+extern "C" {
+	#include <knxproto/proto/cemi.h>
+}
+
+#include <uv.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+// Frame with its own copy of the TPDU payload. Frames are kept as cEMI rather than as encoded
+// tunnelling requests because libknxproto assigns channel id and sequence number when it sends
+// them, and a reconnect renumbers everything that is still queued. Only the frame in flight is
+// resent with a fixed sequence number, see 'OutboundQueueHandlers::resend'.
+struct QueuedFrame {
+	knx_cemi cemi;
+	uint8_t payload[255];
+
+	// Fails if the payload exceeds the frame
+	bool store(const knx_cemi& frame);
+
+	// Copies move the payload, hence the payload pointer is only fixed up before use
+	knx_cemi& restore();
+};
+
+// Growable ring buffer of outbound frames
+struct FrameRing {
+	QueuedFrame* slots;
+	size_t capacity;
+	size_t head;
+	size_t length;
+
+	// Number of frames popped so far, turns the positions below into slots
+	uint64_t popped;
+
+	// Present while coalescing, maps a group address to the position of its unsent write
+	std::unordered_map<uint16_t, uint64_t>* writes;
+
+	// Number of writes that replaced an unsent one
+	uint64_t coalesced;
+
+	void init(size_t capacity);
+
+	void release();
+
+	void set_coalescing(bool enable);
+
+	// Fails if the payload exceeds a slot. While coalescing, a GroupValueWrite replaces the payload
+	// of an unsent write to the same group address instead of taking a new slot.
+	bool push(const knx_cemi& frame);
+
+	QueuedFrame& front();
+
+	// The front frame has been sent, writes must no longer coalesce into it
+	void seal_front();
+
+	// The front frame was not sent after all. Writes coalesce into it again, unless one to the same
+	// destination has been queued in the meantime.
+	void unseal_front();
+
+	void pop();
+};
+
+struct OutboundQueueHandlers {
+	// Yields the sequence number of the request, or a negative value if it could not be sent
+	int32_t (* send)(void* data, const knx_cemi* frame);
+
+	// Repeats the request 'seq_number' without taking a new sequence number
+	bool (* resend)(void* data, uint8_t seq_number, const knx_cemi* frame);
+
+	// Invoked from the event loop, must call 'OutboundQueue::retransmit' from a suitable scope
+	void (* timeout)(void* data);
+
+	// The frame to 'destination' has not been acknowledged despite all retries and has been dropped.
+	// KNXnet/IP requires the connection to be torn down then, the queue carries on with the next
+	// 'kick'.
+	void (* abandon)(void* data, knx_addr destination);
+};
+
+// Retransmission timeout derived from measured round trips as described in RFC 6298. Times are in
+// milliseconds.
+struct RttEstimator {
+	// Smoothed round trip time and its variation, valid once 'measured'
+	double srtt;
+	double rttvar;
+	bool measured;
+
+	double rto;
+	double min_rto;
+	double max_rto;
+
+	// 'initial' applies until the first round trip has been measured
+	void init(double initial, double min_rto, double max_rto);
+
+	void sample(double rtt);
+
+	// Doubles the timeout after it expired
+	void backoff();
+
+	// Timeout for the timer, whole milliseconds
+	uint64_t timeout() const;
+};
+
+// Frames waiting to be sent through a tunnel. The frame at the front stays in flight until it is
+// acknowledged. It is retransmitted whenever the timeout derived from the round trips measured so
+// far expires, and dropped after 'max_retries' retransmissions, see 'abandon'.
+struct OutboundQueue {
+	OutboundQueueHandlers handlers;
+	void* data;
+
+	FrameRing frames;
+
+	bool in_flight;
+	uint8_t seq_number;
+
+	// uv_hrtime() of the first transmission of the frame in flight
+	uint64_t sent_at;
+
+	// Microseconds from the first transmission until the acknowledgement of the last acked frame
+	uint64_t last_rtt;
+
+	// Retransmissions of the frame in flight
+	uint32_t retries;
+	uint32_t max_retries;
+
+	RttEstimator rtt;
+
+	uv_timer_t timer;
+
+	// Retry interval while the tunnel is not ready to send, milliseconds
+	uint64_t interval;
+
+	// 'interval' is also the retransmission timeout until a round trip has been measured
+	static
+	OutboundQueue* create(
+		const OutboundQueueHandlers& handlers,
+		void*                        data,
+		uint64_t                     interval,
+		uv_loop_t*                   loop
+	);
+
+	void configure(double min_rto, double max_rto, uint32_t max_retries);
+
+	bool push(const knx_cemi& frame);
+
+	// Returns true if 'seq_number' acknowledged the frame in flight
+	bool ack(uint8_t seq_number);
+
+	// Send the front frame if none is in flight
+	void kick();
+
+	// Forget about the frame in flight, it will be sent anew by the next 'kick'
+	void reset();
+
+	// Timer expired, resends the frame in flight or gives up on it
+	void retransmit();
+
+	// Deletes the instance once libuv has closed the timer
+	void close();
+
+	void send_front();
+
+	void arm(uint64_t timeout);
+};
+
+#endif
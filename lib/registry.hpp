@@ -0,0 +1,53 @@
+#ifndef KNXPROTO_LIB_REGISTRY_H_
+#define KNXPROTO_LIB_REGISTRY_H_
+
+extern "C" {
+	#include <knxproto/proto/cemi.h>
+}
+
+#include <cstdint>
+
+// DPT registered for each group address, as an index into the table in dpt.cpp
+struct DptRegistry {
+	// Entry plus one, zero marks addresses without a registration
+	uint8_t entries[65536];
+
+	// Addresses whose frames carry the decoded value only, one bit per address
+	uint64_t value_only[65536 / 64];
+
+	inline
+	void set(knx_addr addr, int entry, bool with_payload) {
+		entries[addr] = uint8_t(entry + 1);
+
+		if (with_payload)
+			value_only[addr >> 6] &= ~(uint64_t(1) << (addr & 63));
+		else
+			value_only[addr >> 6] |= uint64_t(1) << (addr & 63);
+	}
+
+	inline
+	void clear(knx_addr addr) {
+		entries[addr] = 0;
+	}
+
+	inline
+	bool keeps_payload(knx_addr addr) const {
+		return !((value_only[addr >> 6] >> (addr & 63)) & 1);
+	}
+
+	// Only group values sent to a registered address are decoded
+	inline
+	bool find(const knx_ldata& ldata, int& entry) const {
+		if (ldata.control2.address_type != KNX_LDATA_ADDR_GROUP ||
+		    (ldata.tpdu.tpci != KNX_TPCI_UNNUMBERED_DATA && ldata.tpdu.tpci != KNX_TPCI_NUMBERED_DATA) ||
+		    (ldata.tpdu.info.data.apci != KNX_APCI_GROUPVALUEWRITE &&
+		     ldata.tpdu.info.data.apci != KNX_APCI_GROUPVALUERESPONSE) ||
+		    entries[ldata.destination] == 0)
+			return false;
+
+		entry = entries[ldata.destination] - 1;
+		return true;
+	}
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef KNXPROTO_LIB_RING_H_
+#define KNXPROTO_LIB_RING_H_
+
+#include <atomic>
+#include <cstddef>
+
+// Bounded queue between exactly one producer thread and one consumer thread. 'N' must be a power
+// of two. Each index is written by one side only, so no locks are needed.
+template <typename T, size_t N>
+struct SpscRing {
+	static_assert((N & (N - 1)) == 0, "Capacity must be a power of two");
+
+	static constexpr size_t capacity = N;
+
+	T items[N];
+
+	// Next item to be consumed, written by the consumer
+	std::atomic<size_t> head {0};
+
+	// Keeps both indices off the same cache line. Over-aligned types can't be allocated with 'new'
+	// before C++17, hence the padding.
+	char padding[64];
+
+	// Next free item, written by the producer
+	std::atomic<size_t> tail {0};
+
+	// Producer side, fails if the ring is full
+	inline
+	bool push(const T& item) {
+		size_t position = tail.load(std::memory_order_relaxed);
+
+		if (position - head.load(std::memory_order_acquire) == N)
+			return false;
+
+		items[position & (N - 1)] = item;
+		tail.store(position + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	// Consumer side, fails if the ring is empty
+	inline
+	bool pop(T& item) {
+		size_t position = head.load(std::memory_order_relaxed);
+
+		if (position == tail.load(std::memory_order_acquire))
+			return false;
+
+		item = items[position & (N - 1)];
+		head.store(position + 1, std::memory_order_release);
+
+		return true;
+	}
+};
+
+#endif
@@ -0,0 +1,156 @@
+#include "scheduler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Lanes are indexed by the priority value; this is the order in which they are served
+static
+const knx_ldata_prio scheduler_service_order[4] = {
+	KNX_LDATA_PRIO_SYSTEM,
+	KNX_LDATA_PRIO_URGENT,
+	KNX_LDATA_PRIO_NORMAL,
+	KNX_LDATA_PRIO_LOW
+};
+
+PacingScheduler* PacingScheduler::create(
+	const PacingHandlers& handlers,
+	void*                 data,
+	double                rate,
+	double                burst,
+	uv_loop_t*            loop
+) {
+	PacingScheduler* scheduler = new PacingScheduler;
+
+	scheduler->handlers = handlers;
+	scheduler->data = data;
+
+	for (PacingLane& lane: scheduler->lanes) {
+		lane.frames.init(16);
+		lane.peak = 0;
+		lane.sent = 0;
+	}
+
+	uv_timer_init(loop, &scheduler->timer);
+	scheduler->timer.data = scheduler;
+
+	scheduler->pumping = false;
+	scheduler->repump = false;
+	scheduler->tokens = 0;
+	scheduler->configure(rate, burst);
+	scheduler->tokens = scheduler->burst;
+	scheduler->refilled_at = uv_now(loop);
+
+	return scheduler;
+}
+
+void PacingScheduler::configure(double new_rate, double new_burst) {
+	rate = new_rate;
+	burst = std::max(new_burst, 1.0);
+	tokens = std::min(tokens, burst);
+}
+
+bool PacingScheduler::push(const knx_cemi& frame) {
+	PacingLane& lane = lanes[frame.payload.ldata.control1.priority & 3];
+
+	if (!lane.frames.push(frame))
+		return false;
+
+	lane.peak = std::max(lane.peak, lane.frames.length);
+	pump();
+
+	return true;
+}
+
+void PacingScheduler::pump() {
+	if (pumping) {
+		repump = true;
+		return;
+	}
+
+	uint64_t now = uv_now(timer.loop);
+
+	tokens = std::min(burst, tokens + (now - refilled_at) * rate / 1000.0);
+	refilled_at = now;
+
+	while (PacingLane* lane = next()) {
+		// Wait until the bucket holds the next token
+		if (tokens < 1) {
+			uint64_t delay = (uint64_t) std::ceil((1 - tokens) * 1000.0 / rate);
+
+			uv_timer_start(&timer, [](uv_timer_t* timer) {
+				PacingScheduler* scheduler = (PacingScheduler*) timer->data;
+				scheduler->handlers.timeout(scheduler->data);
+			}, delay, 0);
+
+			return;
+		}
+
+		// 'send' may push further frames, which can grow the ring or merge into the front frame
+		QueuedFrame frame = lane->frames.front();
+		lane->frames.seal_front();
+
+		pumping = true;
+		repump = false;
+
+		bool sent = handlers.send(data, &frame.restore());
+		pumping = false;
+
+		if (!sent) {
+			lane->frames.unseal_front();
+
+			// The receiving end may have become ready while 'send' ran
+			if (repump) {
+				repump = false;
+				continue;
+			}
+
+			return;
+		}
+
+		lane->frames.pop();
+		lane->sent++;
+		tokens -= 1;
+	}
+}
+
+PacingLane* PacingScheduler::next() {
+	for (knx_ldata_prio priority: scheduler_service_order) {
+		if (lanes[priority].frames.length > 0)
+			return &lanes[priority];
+	}
+
+	return nullptr;
+}
+
+size_t PacingScheduler::length() const {
+	size_t total = 0;
+
+	for (const PacingLane& lane: lanes)
+		total += lane.frames.length;
+
+	return total;
+}
+
+void PacingScheduler::set_coalescing(bool enable) {
+	for (PacingLane& lane: lanes)
+		lane.frames.set_coalescing(enable);
+}
+
+uint64_t PacingScheduler::coalesced() const {
+	uint64_t total = 0;
+
+	for (const PacingLane& lane: lanes)
+		total += lane.frames.coalesced;
+
+	return total;
+}
+
+void PacingScheduler::close() {
+	for (PacingLane& lane: lanes)
+		lane.frames.release();
+
+	uv_timer_stop(&timer);
+	uv_close((uv_handle_t*) &timer, [](uv_handle_t* handle) {
+		delete (PacingScheduler*) handle->data;
+	});
+}
@@ -0,0 +1,78 @@
+#ifndef KNXPROTO_LIB_SCHEDULER_H_
+#define KNXPROTO_LIB_SCHEDULER_H_
+
+#include "queue.hpp"
+
+#include <uv.h>
+
+#include <cstddef>
+#include <cstdint>
+
+struct PacingHandlers {
+	// Returns false if the frame can not be taken right now, it is offered again by the next 'pump'
+	bool (* send)(void* data, const knx_cemi* frame);
+
+	// Invoked from the event loop, must call 'PacingScheduler::pump' from a suitable scope
+	void (* timeout)(void* data);
+};
+
+struct PacingLane {
+	FrameRing frames;
+
+	// Highest number of frames that were waiting at once
+	size_t peak;
+	uint64_t sent;
+};
+
+// Releases outbound frames no faster than the line can carry them. Every L_Data priority has its
+// own lane; lanes are served in the order system, urgent, normal, low. A token bucket holding up
+// to 'burst' telegrams is refilled at 'rate' telegrams per second.
+struct PacingScheduler {
+	PacingHandlers handlers;
+	void* data;
+
+	PacingLane lanes[4];
+
+	double rate;
+	double burst;
+	double tokens;
+	uint64_t refilled_at;
+
+	// Set while frames are handed to 'send', which may call back into 'push' and 'pump'. Nested
+	// calls only leave a note in 'repump' for the outer one.
+	bool pumping;
+	bool repump;
+
+	uv_timer_t timer;
+
+	static
+	PacingScheduler* create(
+		const PacingHandlers& handlers,
+		void*                 data,
+		double                rate,
+		double                burst,
+		uv_loop_t*            loop
+	);
+
+	void configure(double rate, double burst);
+
+	bool push(const knx_cemi& frame);
+
+	// Send as many frames as tokens and the receiving end allow
+	void pump();
+
+	// Lane with the most urgent waiting frame, if any
+	PacingLane* next();
+
+	size_t length() const;
+
+	void set_coalescing(bool enable);
+
+	// Number of writes that were merged into an unsent one
+	uint64_t coalesced() const;
+
+	// Deletes the instance once libuv has closed the timer
+	void close();
+};
+
+#endif
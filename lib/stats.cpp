@@ -0,0 +1,68 @@
+#include "stats.hpp"
+
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram() {
+	for (size_t i = 0; i < bucket_count; i++)
+		buckets[i] = 0;
+}
+
+size_t LatencyHistogram::bucket_of(uint64_t value) {
+	if (value < sub_buckets)
+		return value;
+
+	size_t msb = 63 - __builtin_clzll(value);
+
+	if (msb >= max_bits)
+		return bucket_count - 1;
+
+	// The bits below the highest one pick the linear bucket within its power of two
+	size_t shift = msb - sub_bits;
+	return (shift + 1) * sub_buckets + ((value >> shift) - sub_buckets);
+}
+
+uint64_t LatencyHistogram::bucket_floor(size_t bucket) {
+	size_t range = bucket / sub_buckets;
+	uint64_t sub = bucket % sub_buckets;
+
+	if (range == 0)
+		return sub;
+
+	return (sub_buckets + sub) << (range - 1);
+}
+
+void LatencyHistogram::record(uint64_t value) {
+	buckets[bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+
+	count.fetch_add(1, std::memory_order_relaxed);
+	sum.fetch_add(value, std::memory_order_relaxed);
+
+	uint64_t low = min.load(std::memory_order_relaxed);
+	while (value < low && !min.compare_exchange_weak(low, value, std::memory_order_relaxed));
+
+	uint64_t high = max.load(std::memory_order_relaxed);
+	while (value > high && !max.compare_exchange_weak(high, value, std::memory_order_relaxed));
+}
+
+uint64_t LatencyHistogram::percentile(double percentile) const {
+	uint64_t total = count.load(std::memory_order_relaxed);
+	if (total == 0) return 0;
+
+	uint64_t target = (uint64_t) std::ceil(total * percentile / 100);
+	if (target == 0) target = 1;
+
+	uint64_t seen = 0;
+
+	for (size_t i = 0; i < bucket_count; i++) {
+		seen += buckets[i].load(std::memory_order_relaxed);
+
+		if (seen >= target) {
+			uint64_t high = i + 1 < bucket_count ? bucket_floor(i + 1) - 1 : bucket_floor(i);
+			uint64_t highest = max.load(std::memory_order_relaxed);
+
+			return high < highest ? high : highest;
+		}
+	}
+
+	return max.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,82 @@
+#ifndef KNXPROTO_LIB_STATS_H_
+#define KNXPROTO_LIB_STATS_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Log-linear histogram in the manner of HdrHistogram. Values below 'sub_buckets' have a bucket of
+// their own, above that every power of two is split into 'sub_buckets' equal buckets, which keeps
+// the relative error below 1/16. Safe to record into from one thread while another reads.
+struct LatencyHistogram {
+	static constexpr size_t sub_bits = 4;
+	static constexpr size_t sub_buckets = 1 << sub_bits;
+
+	// Larger values are clamped
+	static constexpr size_t max_bits = 36;
+	static constexpr size_t bucket_count = (max_bits - sub_bits + 1) * sub_buckets;
+
+	std::atomic<uint64_t> buckets[bucket_count];
+
+	std::atomic<uint64_t> count {0};
+	std::atomic<uint64_t> sum {0};
+	std::atomic<uint64_t> min {UINT64_MAX};
+	std::atomic<uint64_t> max {0};
+
+	LatencyHistogram();
+
+	void record(uint64_t value);
+
+	// Highest value which is equivalent to the one at 'percentile' (0 to 100), zero if empty
+	uint64_t percentile(double percentile) const;
+
+	static
+	size_t bucket_of(uint64_t value);
+
+	// Lowest value falling into 'bucket'
+	static
+	uint64_t bucket_floor(size_t bucket);
+};
+
+// Counters of a router or tunnel. They are written by the thread running the protocol, which may be
+// a worker, hence they are atomic.
+struct WireStats {
+	std::atomic<uint64_t> datagrams_in {0};
+	std::atomic<uint64_t> datagrams_out {0};
+	std::atomic<uint64_t> bytes_in {0};
+	std::atomic<uint64_t> bytes_out {0};
+
+	std::atomic<uint64_t> frames_decoded {0};
+
+	// Datagrams which the protocol rejected
+	std::atomic<uint64_t> decode_failures {0};
+
+	std::atomic<uint64_t> resends {0};
+
+	// Calls into JavaScript and the nanoseconds spent in them
+	std::atomic<uint64_t> callbacks {0};
+	std::atomic<uint64_t> callback_time {0};
+
+	inline
+	void received(size_t length, bool accepted) {
+		datagrams_in.fetch_add(1, std::memory_order_relaxed);
+		bytes_in.fetch_add(length, std::memory_order_relaxed);
+
+		if (!accepted)
+			decode_failures.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	inline
+	void sent(size_t length) {
+		datagrams_out.fetch_add(1, std::memory_order_relaxed);
+		bytes_out.fetch_add(length, std::memory_order_relaxed);
+	}
+
+	inline
+	void called(uint64_t nanoseconds) {
+		callbacks.fetch_add(1, std::memory_order_relaxed);
+		callback_time.fetch_add(nanoseconds, std::memory_order_relaxed);
+	}
+};
+
+#endif
@@ -0,0 +1,131 @@
+#include "transport.hpp"
+
+#include <algorithm>
+
+struct UdpSendRequest {
+	uv_udp_send_t request;
+	char* data;
+};
+
+static
+void udp_transport_alloc(uv_handle_t* handle, size_t suggested_size, uv_buf_t* buf) {
+	UdpTransport* transport = (UdpTransport*) handle->data;
+	*buf = uv_buf_init(transport->buffer, sizeof(transport->buffer));
+}
+
+static
+void udp_transport_recv(
+	uv_udp_t*              handle,
+	ssize_t                nread,
+	const uv_buf_t*        buf,
+	const struct sockaddr* addr,
+	unsigned               flags
+) {
+	UdpTransport* transport = (UdpTransport*) handle->data;
+
+	if (nread <= 0 || !addr || (flags & UV_UDP_PARTIAL) || !transport->handler)
+		return;
+
+	transport->handler(transport->data, (const uint8_t*) buf->base, nread);
+}
+
+static
+void udp_transport_sent(uv_udp_send_t* request, int status) {
+	UdpSendRequest* send_request = (UdpSendRequest*) request->data;
+
+	delete[] send_request->data;
+	delete send_request;
+}
+
+UdpTransport* UdpTransport::open(
+	uint32_t    address,
+	uint16_t    port,
+	bool        multicast,
+	bool        loopback,
+	RecvHandler handler,
+	void*       data,
+	uv_loop_t*  loop
+) {
+	UdpTransport* transport = new UdpTransport;
+	transport->handler = handler;
+	transport->data = data;
+
+	transport->remote.sin_family = AF_INET;
+	transport->remote.sin_port = htons(port);
+	transport->remote.sin_addr.s_addr = htonl(address);
+
+	if (uv_udp_init(loop, &transport->handle) != 0) {
+		delete transport;
+		return nullptr;
+	}
+
+	transport->handle.data = transport;
+
+	sockaddr_in local;
+	uv_ip4_addr("0.0.0.0", multicast ? port : 0, &local);
+
+	bool success = uv_udp_bind(&transport->handle, (const sockaddr*) &local, multicast ? UV_UDP_REUSEADDR : 0) == 0;
+
+	if (success && multicast) {
+		char group[16];
+		uv_ip4_name(&transport->remote, group, sizeof(group));
+
+		success =
+			uv_udp_set_membership(&transport->handle, group, nullptr, UV_JOIN_GROUP) == 0 &&
+			uv_udp_set_multicast_loop(&transport->handle, loopback) == 0;
+	}
+
+	if (success)
+		success = uv_udp_recv_start(&transport->handle, udp_transport_alloc, udp_transport_recv) == 0;
+
+	if (!success) {
+		transport->close();
+		return nullptr;
+	}
+
+	return transport;
+}
+
+bool UdpTransport::send(const uint8_t* message, size_t length) {
+	uv_buf_t buf = uv_buf_init((char*) message, length);
+
+	// Most datagrams can be sent right away, which spares us copying them
+	int written = uv_udp_try_send(&handle, &buf, 1, (const sockaddr*) &remote);
+	if (written >= 0)
+		return true;
+	else if (written != UV_EAGAIN)
+		return false;
+
+	UdpSendRequest* send_request = new UdpSendRequest;
+	send_request->request.data = send_request;
+	send_request->data = new char[length];
+	std::copy(message, message + length, send_request->data);
+
+	buf = uv_buf_init(send_request->data, length);
+
+	if (uv_udp_send(&send_request->request, &handle, &buf, 1, (const sockaddr*) &remote, udp_transport_sent) != 0) {
+		delete[] send_request->data;
+		delete send_request;
+
+		return false;
+	}
+
+	return true;
+}
+
+void UdpTransport::pause() {
+	uv_udp_recv_stop(&handle);
+}
+
+void UdpTransport::resume() {
+	uv_udp_recv_start(&handle, udp_transport_alloc, udp_transport_recv);
+}
+
+void UdpTransport::close() {
+	handler = nullptr;
+
+	uv_udp_recv_stop(&handle);
+	uv_close((uv_handle_t*) &handle, [](uv_handle_t* handle) {
+		delete (UdpTransport*) handle->data;
+	});
+}
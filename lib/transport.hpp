@@ -0,0 +1,46 @@
+#ifndef KNXPROTO_LIB_TRANSPORT_H_
+#define KNXPROTO_LIB_TRANSPORT_H_
+
+#include <uv.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// UDP socket on an event loop, which hands received datagrams to 'handler' directly
+struct UdpTransport {
+	using RecvHandler = void (*)(void* data, const uint8_t* message, size_t length);
+
+	uv_udp_t handle;
+	sockaddr_in remote;
+
+	RecvHandler handler;
+	void* data;
+
+	char buffer[512];
+
+	// Multicast transports bind to 'port' and join the group at 'address' (host byte order),
+	// others use an ephemeral port. With 'loopback', datagrams sent to the group also reach sockets
+	// on this host. Returns nullptr if the socket could not be set up.
+	static
+	UdpTransport* open(
+		uint32_t    address,
+		uint16_t    port,
+		bool        multicast,
+		bool        loopback,
+		RecvHandler handler,
+		void*       data,
+		uv_loop_t*  loop
+	);
+
+	bool send(const uint8_t* message, size_t length);
+
+	// Stop and resume reading from the socket, datagrams wait in the kernel's buffer meanwhile
+	void pause();
+
+	void resume();
+
+	// Deletes the instance once libuv has closed the handle
+	void close();
+};
+
+#endif
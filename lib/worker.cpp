@@ -0,0 +1,141 @@
+#include "worker.hpp"
+
+static
+void protocol_worker_commands(uv_async_t* handle) {
+	ProtocolWorker* worker = (ProtocolWorker*) handle->data;
+
+	if (worker->stopping) {
+		worker->handlers.stop(worker->data);
+		uv_close((uv_handle_t*) &worker->commands_async, nullptr);
+
+		return;
+	}
+
+	ProtocolMessage message;
+	while (worker->commands.pop(message))
+		worker->handlers.command(worker->data, message);
+
+	// The JavaScript thread wakes the worker as well once it has caught up with the events
+	if (worker->paused && !worker->spilled && worker->available() >= worker->reserve) {
+		worker->paused = false;
+		worker->handlers.pause(worker->data, false);
+	}
+}
+
+static
+void protocol_worker_events(uv_async_t* handle) {
+	ProtocolWorker* worker = (ProtocolWorker*) handle->data;
+	worker->handlers.wake(worker->data);
+}
+
+ProtocolWorker* ProtocolWorker::create(const ProtocolWorkerHandlers& handlers, void* data, uv_loop_t* events_loop) {
+	ProtocolWorker* worker = new ProtocolWorker;
+
+	worker->handlers = handlers;
+	worker->data = data;
+	worker->running = false;
+
+	worker->spilled = false;
+	worker->paused = false;
+	worker->stopping = false;
+	worker->dropped = 0;
+	worker->backlog = 0;
+
+	uv_loop_init(&worker->loop);
+
+	uv_async_init(&worker->loop, &worker->commands_async, protocol_worker_commands);
+	worker->commands_async.data = worker;
+
+	uv_async_init(events_loop, &worker->events_async, protocol_worker_events);
+	worker->events_async.data = worker;
+
+	return worker;
+}
+
+bool ProtocolWorker::run() {
+	running = uv_thread_create(&thread, [](void* data) {
+		ProtocolWorker* worker = (ProtocolWorker*) data;
+
+		uv_run(&worker->loop, UV_RUN_DEFAULT);
+		uv_loop_close(&worker->loop);
+	}, this) == 0;
+
+	return running;
+}
+
+bool ProtocolWorker::submit(const ProtocolMessage& message) {
+	if (!commands.push(message))
+		return false;
+
+	uv_async_send(&commands_async);
+	return true;
+}
+
+size_t ProtocolWorker::available() const {
+	return events.capacity - (events.tail.load(std::memory_order_relaxed) - events.head.load(std::memory_order_acquire));
+}
+
+bool ProtocolWorker::emit(const ProtocolMessage& message) {
+	if (spilled || !events.push(message)) {
+		if (message.kind == PROTOCOL_RECV && !spilled) {
+			dropped++;
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(overflow_mutex);
+
+		overflow.push_back(message);
+		spilled = true;
+	}
+
+	if (!paused && (spilled || available() < reserve)) {
+		paused = true;
+		handlers.pause(data, true);
+	}
+
+	// Wake-ups coalesce, the JavaScript thread drains everything that is waiting
+	uv_async_send(&events_async);
+	return true;
+}
+
+bool ProtocolWorker::next(ProtocolMessage& message) {
+	// Overflowed events are newer than anything left in the ring when they were taken
+	if (spilled_events.empty() && !events.pop(message)) {
+		if (spilled) {
+			std::lock_guard<std::mutex> lock(overflow_mutex);
+
+			spilled_events.swap(overflow);
+			spilled = false;
+		}
+
+		if (spilled_events.empty()) {
+			if (paused) uv_async_send(&commands_async);
+			return false;
+		}
+	} else if (spilled_events.empty()) {
+		return true;
+	}
+
+	message = spilled_events.front();
+	spilled_events.pop_front();
+
+	return true;
+}
+
+void ProtocolWorker::close() {
+	stopping = true;
+
+	if (running) {
+		uv_async_send(&commands_async);
+		uv_thread_join(&thread);
+	} else {
+		handlers.stop(data);
+		uv_close((uv_handle_t*) &commands_async, nullptr);
+		uv_run(&loop, UV_RUN_DEFAULT);
+		uv_loop_close(&loop);
+	}
+
+	uv_close((uv_handle_t*) &events_async, [](uv_handle_t* handle) {
+		delete (ProtocolWorker*) handle->data;
+	});
+}
@@ -0,0 +1,95 @@
+#ifndef KNXPROTO_LIB_WORKER_H_
+#define KNXPROTO_LIB_WORKER_H_
+
+#include "message.hpp"
+#include "ring.hpp"
+
+#include <uv.h>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+struct ProtocolWorkerHandlers {
+	// Invoked on the worker thread for every command
+	void (* command)(void* data, ProtocolMessage& message);
+
+	// Invoked before the worker loop exits, must close every other handle on it
+	void (* stop)(void* data);
+
+	// Invoked on the JavaScript thread when events are waiting, must take them with 'next'
+	void (* wake)(void* data);
+
+	// Invoked on the worker thread when the events back up and once they have been taken again,
+	// the owner should stop and resume reading datagrams respectively
+	void (* pause)(void* data, bool paused);
+};
+
+// Event loop on a thread of its own. Commands and events are passed through rings, each side wakes
+// the other with an async handle. Received frames are never allowed to fill the event ring: the
+// owner is asked to pause reading while fewer than 'reserve' slots are left. Other events are never
+// lost, those which do not fit wait in an overflow queue, in order.
+struct ProtocolWorker {
+	ProtocolWorkerHandlers handlers;
+	void* data;
+
+	uv_loop_t loop;
+	uv_thread_t thread;
+	bool running;
+
+	// Lives on the worker loop
+	uv_async_t commands_async;
+
+	// Lives on the event loop of the JavaScript thread
+	uv_async_t events_async;
+
+	SpscRing<ProtocolMessage, 256> commands;
+	SpscRing<ProtocolMessage, 1024> events;
+
+	static constexpr size_t reserve = 64;
+
+	// Once something has overflowed, all events go through 'overflow' until the JavaScript thread
+	// has taken them, which keeps them in order
+	std::mutex overflow_mutex;
+	std::deque<ProtocolMessage> overflow;
+	std::atomic<bool> spilled;
+
+	// Events taken from 'overflow', JavaScript thread
+	std::deque<ProtocolMessage> spilled_events;
+
+	// Set while the owner has been asked to pause, written by the worker thread
+	std::atomic<bool> paused;
+
+	std::atomic<bool> stopping;
+
+	// Received frames lost to a full ring, despite pausing
+	std::atomic<uint64_t> dropped;
+
+	// Frames held by the worker, maintained by the owner
+	std::atomic<uint32_t> backlog;
+
+	// Handles may be added to 'loop' until 'run' is called. 'events_loop' belongs to the JavaScript
+	// thread which receives the events.
+	static
+	ProtocolWorker* create(const ProtocolWorkerHandlers& handlers, void* data, uv_loop_t* events_loop);
+
+	bool run();
+
+	// JavaScript thread, fails if the worker is lagging behind
+	bool submit(const ProtocolMessage& message);
+
+	// Worker thread
+	bool emit(const ProtocolMessage& message);
+
+	// JavaScript thread, false once there are no more events
+	bool next(ProtocolMessage& message);
+
+	// Free slots of the event ring, as seen by the worker thread
+	size_t available() const;
+
+	// Stops and joins the thread, deletes the instance once the remaining handle has been closed
+	void close();
+};
+
+#endif
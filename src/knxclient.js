@@ -1,5 +1,6 @@
 var EventEmitter = require("events");
 var dgram        = require("dgram");
+var dns          = require("dns");
 var proto        = require("bindings")("knxproto.node");
 
 ///////////////
@@ -30,11 +31,83 @@ function packIndividual(a, b, c) {
 	);
 }
 
+var dptNames = {
+	unsigned8:  proto.DptUnsigned8,
+	unsigned16: proto.DptUnsigned16,
+	unsigned32: proto.DptUnsigned32,
+	signed8:    proto.DptSigned8,
+	signed16:   proto.DptSigned16,
+	signed32:   proto.DptSigned32,
+	float16:    proto.DptFloat16,
+	float32:    proto.DptFloat32,
+	bool:       proto.DptBool,
+	char:       proto.DptChar,
+	cvalue:     proto.DptCValue,
+	cstep:      proto.DptCStep,
+	timeofday:  proto.DptTimeOfDay,
+	date:       proto.DptDate
+};
+
+// Identifiers of the DPT strings seen so far
+var dptIds = Object.create(null);
+
+// Turns "9.001" or "DPT-9.001" into the identifier used by 'unpack' and 'pack'
+function dptId(dpt) {
+	if (typeof dpt != "string")
+		return dpt;
+
+	var id = dptIds[dpt];
+
+	if (id === undefined) {
+		var parts = dpt.replace(/^DPS?T-/i, "").split(/[.-]/);
+		id = dptIds[dpt] = ((parts[0] & 0xFFFF) << 16 | ((parts[1] || 0) & 0xFFFF)) >>> 0;
+	}
+
+	return id;
+}
+
+// What 'registerDpt' takes: a type name such as "float16", a DPT string such as "5.001" or either
+// of their numeric values. Strings which are neither yield null.
+function dptType(dpt) {
+	if (typeof dpt != "string")
+		return dpt;
+
+	var type = dptNames[dpt.toLowerCase()];
+	if (type !== undefined)
+		return type;
+
+	var id = dptId(dpt);
+	return id >= 0x10000 ? id : null;
+}
+
+function unpack(dpt, payload) {
+	return proto.unpack(dptId(dpt), payload);
+}
+
+function pack(dpt, value) {
+	return proto.pack(dptId(dpt), value);
+}
+
+function packInto(dpt, buffer, offset, value) {
+	return proto.packInto(dptId(dpt), buffer, offset, value);
+}
+
+function packIPv4(addr) {
+	var parts = addr.split(".");
+
+	return (
+		((parts[0] & 255) << 24) |
+		((parts[1] & 255) << 16) |
+		((parts[2] & 255) << 8) |
+		(parts[3] & 255)
+	) >>> 0;
+}
+
 ///////////////////
 // Router client //
 ///////////////////
 
-function Router(host, port) {
+function Router(host, port, options) {
 	EventEmitter.prototype.constructor.call(this);
 
 	this.host = host || "224.0.23.12",
@@ -45,20 +118,29 @@ function Router(host, port) {
 			this.sock.send(buf, 0, buf.length, this.port, this.host);
 		}.bind(this),
 
-		function (msg) {
-			if (!msg) return;
-
-			if (msg.service == proto.LDataIndication)
-				this.emit("indication", msg.payload.source, msg.payload.destination, msg.payload.tpdu);
-			else if (msg.service == proto.LDataConfirmation)
-				this.emit("confirmation", msg.payload.source, msg.payload.destination, msg.payload.tpdu);
-		}.bind(this)
+		this.dispatch.bind(this)
 	);
 
+	// Payloads and raw cEMI frames become views onto the received datagram instead of copies
+	if (options && options.zeroCopy)
+		proto.setRouterZeroCopy(this.ext, true);
+
+	// The native transport receives and sends without involving JavaScript. With 'loopback', frames
+	// also reach other sockets on this host, such as a local simulator.
+	if (options && options.native) {
+		this.sock = null;
+
+		if (!proto.openRouter(this.ext, packIPv4(this.host), this.port, !!options.loopback))
+			throw new Error("Failed to open native router transport");
+
+		return;
+	}
+
 	this.sock = dgram.createSocket({type: "udp4", reuseAddr: true});
+	// With 'loopback', frames also reach other sockets on this host, such as a local simulator
 	this.sock.bind(this.port, function () {
 		this.sock.addMembership(this.host);
-		this.sock.setMulticastLoopback(false);
+		this.sock.setMulticastLoopback(!!(options && options.loopback));
 	}.bind(this));
 
 	this.sock.on("message", function (msg) {
@@ -75,16 +157,151 @@ function Router(host, port) {
 
 Router.prototype.__proto__ = EventEmitter.prototype;
 
+// Receives the frames gathered while batched delivery is enabled
+Router.prototype.dispatchAll = function (frames) {
+	for (var i = 0; i < frames.length; i++)
+		this.dispatch(frames[i]);
+};
+
+Router.prototype.dispatch = function (msg) {
+	if (!msg) return;
+
+	if (msg.service == proto.LDataIndication)
+		this.emit("indication", msg.payload.source, msg.payload.destination, msg.payload.tpdu);
+	else if (msg.service == proto.LDataConfirmation)
+		this.emit("confirmation", msg.payload.source, msg.payload.destination, msg.payload.tpdu);
+};
+
+Router.prototype.processBatch = function (msgs) {
+	if (!this.ext) return;
+
+	var frames = proto.processRouterBatch(this.ext, msgs);
+	for (var i = 0; i < frames.length; i++)
+		this.dispatch(frames[i]);
+};
+
+// Decode frames into typed arrays instead of objects. The returned columns are reused by every
+// call to 'processColumns', which yields the number of frames they hold afterwards. 'apci' is a
+// Uint16Array as the APCI takes 10 bits. Yields null for a capacity or arena size of zero.
+Router.prototype.enableColumns = function (capacity, arenaSize) {
+	if (this.ext) return proto.enableRouterColumns(this.ext, capacity == null ? 4096 : capacity, arenaSize == null ? 65536 : arenaSize);
+};
+
+Router.prototype.processColumns = function (msgs) {
+	return this.ext ? proto.processRouterColumns(this.ext, msgs) : 0;
+};
+
+// Once something has been subscribed, frames to other group addresses are dropped natively.
+// Yields false and changes nothing if an entry is not a group address (0 to 0xFFFF).
+Router.prototype.subscribe = function (addrs) {
+	return this.ext != null && proto.subscribeRouter(this.ext, Array.isArray(addrs) ? addrs : [addrs]);
+};
+
+Router.prototype.unsubscribe = function (addrs) {
+	return this.ext != null && proto.unsubscribeRouter(this.ext, Array.isArray(addrs) ? addrs : [addrs]);
+};
+
+Router.prototype.filtered = function () {
+	return this.ext ? proto.filteredRouter(this.ext) : 0;
+};
+
+// Last GroupValueWrite or GroupValueResponse seen for a group address, or null
+Router.prototype.lookup = function (addr) {
+	return this.ext ? proto.lookupRouter(this.ext, addr) : null;
+};
+
+Router.prototype.snapshot = function () {
+	return this.ext ? proto.snapshotRouter(this.ext) : [];
+};
+
+// Values sent to the group address are decoded natively and attached to the TPDU as 'value'. Every
+// DPT 'unpack' knows can be registered, by name or as a string like "5.001". With 'options.payload'
+// set to false the TPDU carries no 'payload', which saves copying it.
+Router.prototype.registerDpt = function (addr, dpt, options) {
+	var type = dptType(dpt);
+	var withPayload = !(options && options.payload === false);
+
+	return this.ext != null && type != null && proto.registerRouterDpt(this.ext, addr, type, withPayload);
+};
+
+Router.prototype.unregisterDpt = function (addr) {
+	if (this.ext) proto.unregisterRouterDpt(this.ext, addr);
+};
+
 Router.prototype.send = function (cemi) {
 	if (this.ext) return proto.sendRouter(this.ext, cemi);
 };
 
-Router.prototype.write = function (src, dest, payload) {
+// Release outgoing frames at no more than 'rate' telegrams per second, most urgent priority first
+Router.prototype.setPacing = function (rate, burst) {
+	return this.ext != null && proto.setRouterPacing(this.ext, rate, burst || 1);
+};
+
+Router.prototype.pacingStats = function () {
+	return this.ext ? proto.routerPacingStats(this.ext) : null;
+};
+
+// Gather received frames natively and dispatch them once per event loop turn, or as soon as
+// 'maxEvents' are waiting or the oldest has waited for 'maxDelay' microseconds
+Router.prototype.enableBatchedDelivery = function (maxEvents, maxDelay) {
+	if (this.ext) proto.enableRouterDelivery(this.ext, this.dispatchAll.bind(this), maxEvents || 256, maxDelay || 1000);
+};
+
+Router.prototype.disableBatchedDelivery = function () {
+	if (this.ext) proto.disableRouterDelivery(this.ext);
+};
+
+// Let a write replace the payload of an unsent write to the same group address. Takes effect
+// while pacing, as frames are sent right away otherwise.
+Router.prototype.setCoalescing = function (enable) {
+	if (this.ext) proto.setRouterCoalescing(this.ext, !!enable);
+};
+
+Router.prototype.coalesced = function () {
+	return this.ext ? proto.coalescedRouter(this.ext) : 0;
+};
+
+// Counters of datagrams, bytes, decoded frames and time spent in callbacks. Cheap enough to be read
+// on every scrape of a metrics endpoint.
+Router.prototype.getStats = function () {
+	return this.ext ? proto.routerStats(this.ext) : null;
+};
+
+// Have 'callback' receive the statistics every 'interval' milliseconds, zero stops it
+Router.prototype.pushStats = function (interval, callback) {
+	if (this.ext) proto.setRouterStatsInterval(this.ext, callback || function () {}, interval || 0);
+};
+
+// Append every datagram to a binary log of memory-mapped segments named '<path>.<n>.knxcap'.
+// Segments hold 'segmentSize' bytes (16 MiB by default); with 'maxSegments' only the most recent
+// ones are kept. Fails if there are segments at 'path' already, earlier captures are never touched.
+Router.prototype.startCapture = function (path, options) {
+	options = options || {};
+	return this.ext != null && proto.startRouterCapture(this.ext, path, options.segmentSize || 16777216, options.maxSegments || 0);
+};
+
+// Returns the number of records, bytes, dropped records and segments written
+Router.prototype.stopCapture = function () {
+	return this.ext ? proto.stopRouterCapture(this.ext) : null;
+};
+
+// Feed the received datagrams of a capture log through the router, 'speed' times as fast as they
+// were recorded, or as fast as possible if 'speed' is zero. 'callback' gets the number of datagrams.
+Router.prototype.replay = function (path, speed, callback) {
+	return this.ext != null && proto.replayRouter(this.ext, path, speed || 0, callback || function () {});
+};
+
+Router.prototype.stopReplay = function () {
+	if (this.ext) proto.stopRouterReplay(this.ext);
+};
+
+Router.prototype.write = function (src, dest, payload, priority) {
 	return this.send({
 		service: proto.LDataIndication,
 		payload: {
 			source: src,
 			destination: dest,
+			priority: priority,
 			tpdu: {
 				tpci: proto.UnnumberedData,
 				apci: proto.GroupValueWrite,
@@ -95,6 +312,13 @@ Router.prototype.write = function (src, dest, payload) {
 };
 
 Router.prototype.dispose = function () {
+	if (!this.sock) {
+		if (this.ext) proto.disposeRouter(this.ext);
+		this.ext = null;
+
+		return;
+	}
+
 	this.sock.dropMembership(this.host);
 	this.sock.close();
 };
@@ -103,115 +327,59 @@ Router.prototype.dispose = function () {
 // Tunnel client //
 ///////////////////
 
-function OutboundQueue(send, resend) {
-	this.idle = true;
-	this.outbound = [];
-
-	this.send = send;
-	this.resend = resend;
-}
-
-OutboundQueue.prototype.queue = function (msg) {
-	this.outbound.unshift(msg);
-
-	if (this.idle) {
-		this.info = this.send(this.outbound[this.outbound.length - 1]);
-		this.idle = false;
-		this.resetInterval();
-	}
-};
-
-OutboundQueue.prototype.confirm = function () {
-	var item = this.outbound.pop();
-
-	if (this.outbound.length == 0) {
-		this.idle = true;
-	} else {
-		this.info = this.send(this.outbound[this.outbound.length - 1]);
-		this.idle = false;
-		this.resetInterval();
-	}
-
-	return item;
-};
-
-OutboundQueue.prototype.resetInterval = function () {
-	if (this.interval)
-		clearInterval(this.interval);
-
-	this.interval = setInterval(function () {
-		if (this.outbound.length > 0)
-			this.resend(this.info, this.outbound[this.outbound.length - 1]);
-	}.bind(this), 1000);
-};
-
-OutboundQueue.prototype.clearInterval = function () {
-	if (this.interval)
-		clearInterval(this.interval);
-
-	this.interval = null;
-};
-
-function Tunnel(host, port) {
+function Tunnel(host, port, options) {
 	EventEmitter.prototype.constructor.call(this);
 
 	this.host = host || "localhost";
 	this.port = port || 3671;
-
-	this.outbound = new OutboundQueue(
-		function (cemi) {
-			if (this.ext) {
-				var no = proto.sendTunnel(this.ext, cemi);
-				return no;
-			}
-		}.bind(this),
-
-		function (no, cemi) {
-			if (this.ext && no != null) {
-				proto.resendTunnel(this.ext, no, cemi);
-			}
-		}.bind(this)
-	);
+	this.worker = !!(options && options.worker);
 
 	this.ext = proto.createTunnel(
-		function (state) {
-			switch (state) {
-				case 0:
-					this.emit("connecting");
-					break;
-
-				case 1:
-					this.emit("connected");
-					break;
-
-				case 2:
-					this.emit("disconnecting");
-					break;
-
-				case 3:
-					this.emit("disconnected");
-					break;
-			}
-		}.bind(this),
+		this.changeState.bind(this),
 
 		function (buf) {
 			this.sock.send(buf, 0, buf.length, this.port, this.host);
 		}.bind(this),
 
-		function (msg) {
-			if (!msg) return;
+		this.dispatch.bind(this),
 
-			if (msg.service == proto.LDataIndication)
-				this.emit("indication", msg.payload.source, msg.payload.destination, msg.payload.tpdu, msg);
-			else if (msg.service == proto.LDataConfirmation)
-				this.emit("confirmation", msg.payload.source, msg.payload.destination, msg.payload.tpdu, msg);
+		function (no, dest) {
+			this.emit("ack", no, dest);
 		}.bind(this),
 
-		function (no) {
-			this.outbound.confirm();
+		// A frame went unacknowledged despite all retransmissions, the connection is re-established
+		function (dest) {
+			this.emit("abandon", dest);
 		}.bind(this)
 	);
 
+	// Payloads and raw cEMI frames become views onto the received datagram instead of copies
+	if (options && options.zeroCopy)
+		proto.setTunnelZeroCopy(this.ext, true);
+
+	// The native transport receives and sends without involving JavaScript. With 'worker', it runs
+	// on a thread of its own along with the protocol state machine; pacing and coalescing have to be
+	// configured before the "open" event in that case.
+	if (options && (options.native || options.worker)) {
+		var open = options.worker ? proto.startTunnelWorker : proto.openTunnel;
+
+		this.sock = null;
+		this.opening = true;
+
+		dns.lookup(this.host, 4, function (err, addr) {
+			this.opening = false;
+
+			if (err)
+				this.emit("error", err);
+			else if (this.ext && !open(this.ext, packIPv4(addr), this.port))
+				this.emit("error", new Error("Failed to open native tunnel transport"));
+			else
+				this.emit("open");
+		}.bind(this));
+
+		return;
+	}
+
 	this.sock = dgram.createSocket({type: "udp4", reuseAddr: true});
 
 	this.sock.on("message", function (msg) {
@@ -228,8 +396,109 @@ function Tunnel(host, port) {
 
 Tunnel.prototype.__proto__ = EventEmitter.prototype;
 
+Tunnel.prototype.changeState = function (state) {
+	switch (state) {
+		case 0:
+			this.emit("connecting");
+			break;
+
+		case 1:
+			this.emit("connected");
+			break;
+
+		case 2:
+			this.emit("disconnecting");
+			break;
+
+		case 3:
+			this.emit("disconnected");
+			break;
+	}
+};
+
+// Receives the events gathered while batched delivery is enabled
+Tunnel.prototype.dispatchAll = function (events) {
+	for (var i = 0; i < events.length; i++) {
+		var event = events[i];
+
+		if (event.ack != null)
+			this.emit("ack", event.ack, event.destination);
+		else if (event.abandon != null)
+			this.emit("abandon", event.abandon);
+		else if (event.state != null)
+			this.changeState(event.state);
+		else
+			this.dispatch(event);
+	}
+};
+
+Tunnel.prototype.dispatch = function (msg) {
+	if (!msg) return;
+
+	if (msg.service == proto.LDataIndication)
+		this.emit("indication", msg.payload.source, msg.payload.destination, msg.payload.tpdu, msg);
+	else if (msg.service == proto.LDataConfirmation)
+		this.emit("confirmation", msg.payload.source, msg.payload.destination, msg.payload.tpdu, msg);
+};
+
+// Acknowledgements and state changes caused by the batch are emitted in order with its frames
+Tunnel.prototype.processBatch = function (msgs) {
+	if (!this.ext) return;
+
+	this.dispatchAll(proto.processTunnelBatch(this.ext, msgs));
+};
+
+// Decode frames into typed arrays instead of objects. The returned columns are reused by every
+// call to 'processColumns', which yields the number of frames they hold afterwards. 'apci' is a
+// Uint16Array as the APCI takes 10 bits. Yields null for a capacity or arena size of zero.
+Tunnel.prototype.enableColumns = function (capacity, arenaSize) {
+	if (this.ext) return proto.enableTunnelColumns(this.ext, capacity == null ? 4096 : capacity, arenaSize == null ? 65536 : arenaSize);
+};
+
+Tunnel.prototype.processColumns = function (msgs) {
+	return this.ext ? proto.processTunnelColumns(this.ext, msgs) : 0;
+};
+
+// Once something has been subscribed, frames to other group addresses are dropped natively.
+// Yields false and changes nothing if an entry is not a group address (0 to 0xFFFF).
+Tunnel.prototype.subscribe = function (addrs) {
+	return this.ext != null && proto.subscribeTunnel(this.ext, Array.isArray(addrs) ? addrs : [addrs]);
+};
+
+Tunnel.prototype.unsubscribe = function (addrs) {
+	return this.ext != null && proto.unsubscribeTunnel(this.ext, Array.isArray(addrs) ? addrs : [addrs]);
+};
+
+Tunnel.prototype.filtered = function () {
+	return this.ext ? proto.filteredTunnel(this.ext) : 0;
+};
+
+// Last GroupValueWrite or GroupValueResponse seen for a group address, or null
+Tunnel.prototype.lookup = function (addr) {
+	return this.ext ? proto.lookupTunnel(this.ext, addr) : null;
+};
+
+Tunnel.prototype.snapshot = function () {
+	return this.ext ? proto.snapshotTunnel(this.ext) : [];
+};
+
+// Like 'Router.registerDpt'
+Tunnel.prototype.registerDpt = function (addr, dpt, options) {
+	var type = dptType(dpt);
+	var withPayload = !(options && options.payload === false);
+
+	return this.ext != null && type != null && proto.registerTunnelDpt(this.ext, addr, type, withPayload);
+};
+
+Tunnel.prototype.unregisterDpt = function (addr) {
+	if (this.ext) proto.unregisterTunnelDpt(this.ext, addr);
+};
+
 Tunnel.prototype.connect = function () {
-	if (this.ext) proto.connectTunnel(this.ext);
+	if (this.opening)
+		this.once("open", this.connect.bind(this));
+	else if (this.ext)
+		proto.connectTunnel(this.ext);
 };
 
 Tunnel.prototype.disconnect = function () {
@@ -237,19 +506,90 @@ Tunnel.prototype.disconnect = function () {
 };
 
 Tunnel.prototype.dispose = function () {
+	if (!this.sock) {
+		if (this.ext) proto.disposeTunnel(this.ext);
+		this.ext = null;
+
+		return;
+	}
+
 	this.sock.close();
 };
 
+// Frames are queued natively and retransmitted until the gateway acknowledges them
 Tunnel.prototype.send = function (cemi) {
-	return this.outbound.queue(cemi);
+	return this.ext != null && proto.queueTunnel(this.ext, cemi);
+};
+
+Tunnel.prototype.queued = function () {
+	return this.ext ? proto.queuedTunnel(this.ext) : 0;
+};
+
+// Release outgoing frames at no more than 'rate' telegrams per second, most urgent priority first
+Tunnel.prototype.setPacing = function (rate, burst) {
+	return this.ext != null && proto.setTunnelPacing(this.ext, rate, burst || 1);
+};
+
+Tunnel.prototype.pacingStats = function () {
+	return this.ext ? proto.tunnelPacingStats(this.ext) : null;
 };
 
-Tunnel.prototype.write = function (src, dest, payload) {
+// Gather received frames natively and dispatch them once per event loop turn, or as soon as
+// 'maxEvents' are waiting or the oldest has waited for 'maxDelay' microseconds
+Tunnel.prototype.enableBatchedDelivery = function (maxEvents, maxDelay) {
+	if (this.ext) proto.enableTunnelDelivery(this.ext, this.dispatchAll.bind(this), maxEvents || 256, maxDelay || 1000);
+};
+
+Tunnel.prototype.disableBatchedDelivery = function () {
+	if (this.ext) proto.disableTunnelDelivery(this.ext);
+};
+
+// Let a write replace the payload of an unsent write to the same group address
+Tunnel.prototype.setCoalescing = function (enable) {
+	if (this.ext) proto.setTunnelCoalescing(this.ext, !!enable);
+};
+
+Tunnel.prototype.coalesced = function () {
+	return this.ext ? proto.coalescedTunnel(this.ext) : 0;
+};
+
+// The retransmission timeout follows the measured round trips within 'minTimeout' and 'maxTimeout'
+// milliseconds. After 'maxRetries' retransmissions, by default the one KNXnet/IP allows, a frame is
+// dropped with an "abandon" event and the tunnel reconnects. Has to be set before 'connect' when
+// running on a worker.
+Tunnel.prototype.setRetransmission = function (minTimeout, maxTimeout, maxRetries) {
+	return this.ext != null && proto.setTunnelRetransmit(this.ext, minTimeout || 10, maxTimeout || 4000, maxRetries == null ? 1 : maxRetries);
+};
+
+// Like 'Router.getStats', with the queue depth, a histogram of acknowledgement latencies in
+// microseconds, the number of abandoned frames, the current retransmission timeout and the number
+// of received frames a worker had to drop added
+Tunnel.prototype.getStats = function () {
+	return this.ext ? proto.tunnelStats(this.ext) : null;
+};
+
+Tunnel.prototype.pushStats = function (interval, callback) {
+	if (this.ext) proto.setTunnelStatsInterval(this.ext, callback || function () {}, interval || 0);
+};
+
+// Like 'Router.startCapture'. With a worker, capturing has to start before 'connect' and lasts
+// until the tunnel is disposed.
+Tunnel.prototype.startCapture = function (path, options) {
+	options = options || {};
+	return this.ext != null && proto.startTunnelCapture(this.ext, path, options.segmentSize || 16777216, options.maxSegments || 0);
+};
+
+Tunnel.prototype.stopCapture = function () {
+	return this.ext ? proto.stopTunnelCapture(this.ext) : null;
+};
+
+Tunnel.prototype.write = function (src, dest, payload, priority) {
 	return this.send({
 		service: proto.LDataRequest,
 		payload: {
 			source: src,
 			destination: dest,
+			priority: priority,
 			tpdu: {
 				tpci: proto.UnnumberedData,
 				apci: proto.GroupValueWrite,
@@ -259,6 +599,205 @@ Tunnel.prototype.write = function (src, dest, payload) {
 	});
 };
 
+/////////////////
+// Tunnel pool //
+/////////////////
+
+// Spreads outgoing frames across several tunnel connections to the same gateway. Frames for one
+// destination stay on one channel until all of them have been acknowledged, which keeps them in
+// order. Frames queued on a channel that disconnects are moved to the remaining channels, unless
+// the channel runs a worker, see 'reroute'.
+function TunnelPool(host, port, channels, options) {
+	EventEmitter.prototype.constructor.call(this);
+
+	this.host = host || "localhost";
+	this.port = port || 3671;
+
+	this.channels = [];
+	this.routes = {};
+	this.pacing = null;
+
+	for (var i = 0; i < (channels || 4); i++)
+		this.channels.push(this.createChannel(options));
+}
+
+TunnelPool.prototype.__proto__ = EventEmitter.prototype;
+
+TunnelPool.prototype.createChannel = function (options) {
+	var channel = new Tunnel(this.host, this.port, options);
+
+	channel.alive = false;
+	channel.pending = [];
+
+	channel.on("connected", function () {
+		channel.alive = true;
+		this.splitPacing();
+		this.emit("connected", channel);
+	}.bind(this));
+
+	channel.on("disconnected", function () {
+		channel.alive = false;
+		this.splitPacing();
+		this.reroute(channel);
+		this.emit("disconnected", channel);
+	}.bind(this));
+
+	// Paced channels may acknowledge frames out of submission order
+	channel.on("ack", function (no, dest) {
+		this.settle(channel, dest);
+	}.bind(this));
+
+	channel.on("abandon", function (dest) {
+		this.settle(channel, dest);
+		this.emit("abandon", dest);
+	}.bind(this));
+
+	channel.on("indication", this.emit.bind(this, "indication"));
+	channel.on("confirmation", this.emit.bind(this, "confirmation"));
+	channel.on("error", this.emit.bind(this, "error"));
+
+	return channel;
+};
+
+// Pick the least loaded channel, preferring those that are connected
+TunnelPool.prototype.pick = function () {
+	var best = null;
+
+	for (var i = 0; i < this.channels.length; i++) {
+		var channel = this.channels[i];
+
+		if (
+			best == null ||
+			(channel.alive && !best.alive) ||
+			(channel.alive == best.alive && channel.pending.length < best.pending.length)
+		)
+			best = channel;
+	}
+
+	return best;
+};
+
+// A frame for 'dest' has left the channel, acknowledged or not
+TunnelPool.prototype.settle = function (channel, dest) {
+	var index = channel.pending.indexOf(dest);
+	if (index < 0) return;
+
+	channel.pending.splice(index, 1);
+	this.release(dest);
+};
+
+TunnelPool.prototype.release = function (dest) {
+	var route = this.routes[dest];
+	if (route && --route.count == 0)
+		delete this.routes[dest];
+};
+
+// Move the frames of a dead channel to the others, preserving their order. A worker can't be
+// drained and sends its frames once the channel is connected again, so their destinations stay
+// routed to it meanwhile: later frames to them queue up behind and acknowledgements still settle
+// them.
+TunnelPool.prototype.reroute = function (channel) {
+	if (!channel.ext || channel.worker) return;
+
+	var frames = proto.drainTunnel(channel.ext);
+
+	for (var i = 0; i < channel.pending.length; i++)
+		this.release(channel.pending[i]);
+
+	channel.pending = [];
+
+	for (var i = 0; i < frames.length; i++)
+		this.send(frames[i]);
+};
+
+TunnelPool.prototype.send = function (cemi) {
+	var dest = cemi.payload.destination;
+	var route = this.routes[dest];
+
+	if (!route)
+		route = this.routes[dest] = {channel: this.pick(), count: 0};
+
+	var coalesced = this.coalescing && route.channel.coalesced();
+
+	if (!route.channel.send(cemi)) {
+		if (route.count == 0) delete this.routes[dest];
+		return false;
+	}
+
+	// A merged write is acknowledged along with the one it was merged into
+	if (this.coalescing && route.channel.coalesced() != coalesced)
+		return true;
+
+	route.count++;
+	route.channel.pending.push(dest);
+
+	return true;
+};
+
+TunnelPool.prototype.write = Tunnel.prototype.write;
+
+// 'rate' applies to the pool as a whole, it is divided anew whenever a channel connects or drops
+TunnelPool.prototype.setPacing = function (rate, burst) {
+	this.pacing = {rate: rate, burst: burst};
+	this.splitPacing();
+};
+
+// Channels share the line, hence its rate. Connected channels split it among themselves; before
+// any of them is up, every channel gets an equal share.
+TunnelPool.prototype.splitPacing = function () {
+	if (!this.pacing) return;
+
+	var alive = 0;
+
+	for (var i = 0; i < this.channels.length; i++)
+		if (this.channels[i].alive) alive++;
+
+	var share = this.pacing.rate / (alive || this.channels.length);
+
+	for (i = 0; i < this.channels.length; i++)
+		this.channels[i].setPacing(share, this.pacing.burst);
+};
+
+TunnelPool.prototype.setCoalescing = function (enable) {
+	this.coalescing = !!enable;
+
+	for (var i = 0; i < this.channels.length; i++)
+		this.channels[i].setCoalescing(enable);
+};
+
+TunnelPool.prototype.coalesced = function () {
+	var total = 0;
+
+	for (var i = 0; i < this.channels.length; i++)
+		total += this.channels[i].coalesced();
+
+	return total;
+};
+
+TunnelPool.prototype.queued = function () {
+	var total = 0;
+
+	for (var i = 0; i < this.channels.length; i++)
+		total += this.channels[i].queued();
+
+	return total;
+};
+
+TunnelPool.prototype.connect = function () {
+	for (var i = 0; i < this.channels.length; i++)
+		this.channels[i].connect();
+};
+
+TunnelPool.prototype.disconnect = function () {
+	for (var i = 0; i < this.channels.length; i++)
+		this.channels[i].disconnect();
+};
+
+TunnelPool.prototype.dispose = function () {
+	for (var i = 0; i < this.channels.length; i++)
+		this.channels[i].dispose();
+};
+
 /////////////
 // Exports //
 /////////////
@@ -267,6 +806,7 @@ module.exports = {
 	// Clients
 	Router:                 Router,
 	Tunnel:                 Tunnel,
+	TunnelPool:             TunnelPool,
 
 	// Address
 	packIndividual:         packIndividual,
@@ -275,7 +815,16 @@ module.exports = {
 	unpackIndividual:       unpackIndividual,
 	unpackGroup:            unpackGroup,
 
+	// Diagnostics
+	getBufferPoolStats:     proto.getBufferPoolStats,
+	frameError:             proto.frameError,
+
 	// Data types
+	dptId:                  dptId,
+	unpack:                 unpack,
+	pack:                   pack,
+	packInto:               packInto,
+
 	unpackUnsigned8:        proto.unpackUnsigned8,
 	unpackUnsigned16:       proto.unpackUnsigned16,
 	unpackUnsigned32:       proto.unpackUnsigned32,
@@ -306,12 +855,40 @@ module.exports = {
 	packTimeOfDay:          proto.packTimeOfDay,
 	packDate:               proto.packDate,
 
+	packUnsigned8Into:      proto.packUnsigned8Into,
+	packUnsigned16Into:     proto.packUnsigned16Into,
+	packUnsigned32Into:     proto.packUnsigned32Into,
+	packSigned8Into:        proto.packSigned8Into,
+	packSigned16Into:       proto.packSigned16Into,
+	packSigned32Into:       proto.packSigned32Into,
+	packFloat16Into:        proto.packFloat16Into,
+	packFloat32Into:        proto.packFloat32Into,
+	packBoolInto:           proto.packBoolInto,
+	packCharInto:           proto.packCharInto,
+	packCValueInto:         proto.packCValueInto,
+	packCStepInto:          proto.packCStepInto,
+	packTimeOfDayInto:      proto.packTimeOfDayInto,
+	packDateInto:           proto.packDateInto,
+
+	unpackFloat16Array:     proto.unpackFloat16Array,
+	unpackFloat32Array:     proto.unpackFloat32Array,
+	unpackUnsigned16Array:  proto.unpackUnsigned16Array,
+
+	packFloat16Array:       proto.packFloat16Array,
+	packFloat32Array:       proto.packFloat32Array,
+	packUnsigned16Array:    proto.packUnsigned16Array,
+
 	// CEMI Constants
 	LDataRequest:           proto.LDataRequest,
 	LDataConfirmation:      proto.LDataConfirmation,
 	LDataIndication:        proto.LDataIndication,
 
 	// L_Data constants
+	PrioritySystem:         proto.PrioritySystem,
+	PriorityNormal:         proto.PriorityNormal,
+	PriorityUrgent:         proto.PriorityUrgent,
+	PriorityLow:            proto.PriorityLow,
+
 	NumberedData:           proto.NumberedData,
 	UnnumberedData:         proto.UnnumberedData,
 	NumberedControl:        proto.NumberedControl,
@@ -332,5 +909,21 @@ module.exports = {
 	MaskVersionRead:        proto.MaskVersionRead,
 	MaskVersionResponse:    proto.MaskVersionResponse,
 	Restart:                proto.Restart,
-	Escape:                 proto.Escape
+	Escape:                 proto.Escape,
+
+	// DPT constants
+	DptUnsigned8:           proto.DptUnsigned8,
+	DptUnsigned16:          proto.DptUnsigned16,
+	DptUnsigned32:          proto.DptUnsigned32,
+	DptSigned8:             proto.DptSigned8,
+	DptSigned16:            proto.DptSigned16,
+	DptSigned32:            proto.DptSigned32,
+	DptFloat16:             proto.DptFloat16,
+	DptFloat32:             proto.DptFloat32,
+	DptBool:                proto.DptBool,
+	DptChar:                proto.DptChar,
+	DptCValue:              proto.DptCValue,
+	DptCStep:               proto.DptCStep,
+	DptTimeOfDay:           proto.DptTimeOfDay,
+	DptDate:                proto.DptDate
 };
@@ -0,0 +1,721 @@
+// Tests for the native building blocks which do not depend on V8. Prints one line per failed check
+// and exits with a non-zero status if there was any.
+//
+//   knxproto_test
+
+extern "C" {
+	#include <knxproto/proto/cemi.h>
+}
+
+#include "../lib/capture.hpp"
+#include "../lib/codec.hpp"
+#include "../lib/delivery.hpp"
+#include "../lib/queue.hpp"
+#include "../lib/scheduler.hpp"
+#include "../lib/stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+static int test_failures = 0;
+
+#define TEST_CHECK(condition) test_check((condition), #condition, __FILE__, __LINE__)
+
+static
+void test_check(bool passed, const char* condition, const char* file, int line) {
+	if (passed) return;
+
+	std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, condition);
+	test_failures++;
+}
+
+static
+knx_cemi test_frame(uint16_t destination, knx_apci apci, const uint8_t* payload, size_t length) {
+	knx_cemi frame {};
+
+	frame.service = KNX_CEMI_LDATA_REQ;
+	frame.payload.ldata.control1.priority = KNX_LDATA_PRIO_LOW;
+	frame.payload.ldata.control2.address_type = KNX_LDATA_ADDR_GROUP;
+	frame.payload.ldata.control2.hops = 6;
+	frame.payload.ldata.source = 0x1101;
+	frame.payload.ldata.destination = destination;
+	frame.payload.ldata.tpdu.tpci = KNX_TPCI_UNNUMBERED_DATA;
+	frame.payload.ldata.tpdu.info.data.apci = apci;
+	frame.payload.ldata.tpdu.info.data.payload = payload;
+	frame.payload.ldata.tpdu.info.data.length = length;
+
+	return frame;
+}
+
+// First payload byte of the frame at 'index' from the front
+static
+uint8_t test_ring_value(FrameRing& ring, size_t index) {
+	return ring.slots[(ring.head + index) % ring.capacity].restore().payload.ldata.tpdu.info.data.payload[0];
+}
+
+static
+uint16_t test_ring_destination(FrameRing& ring, size_t index) {
+	return ring.slots[(ring.head + index) % ring.capacity].cemi.payload.ldata.destination;
+}
+
+static
+void test_frame_ring() {
+	uint8_t values[256];
+	for (size_t i = 0; i < 256; i++)
+		values[i] = i;
+
+	FrameRing ring;
+	ring.init(2);
+
+	TEST_CHECK(ring.push(test_frame(0x0801, KNX_APCI_GROUPVALUEWRITE, values + 1, 1)));
+	TEST_CHECK(ring.push(test_frame(0x0802, KNX_APCI_GROUPVALUEWRITE, values + 2, 1)));
+	TEST_CHECK(ring.push(test_frame(0x0801, KNX_APCI_GROUPVALUEWRITE, values + 3, 1)));
+	TEST_CHECK(ring.capacity == 4);
+	TEST_CHECK(ring.length == 3);
+
+	// Payloads which don't fit a slot are refused
+	TEST_CHECK(!ring.push(test_frame(0x0803, KNX_APCI_GROUPVALUEWRITE, values, 256)));
+	TEST_CHECK(ring.length == 3);
+
+	// Wrap around, then grow while the head is not at the start of the slots
+	ring.pop();
+	ring.pop();
+
+	for (uint16_t i = 0; i < 6; i++)
+		TEST_CHECK(ring.push(test_frame(0x0900 + i, KNX_APCI_GROUPVALUEWRITE, values + 100 + i, 1)));
+
+	TEST_CHECK(ring.length == 7);
+	TEST_CHECK(ring.capacity == 8);
+
+	TEST_CHECK(test_ring_destination(ring, 0) == 0x0801);
+	TEST_CHECK(test_ring_value(ring, 0) == 3);
+
+	for (uint16_t i = 0; i < 6; i++) {
+		TEST_CHECK(test_ring_destination(ring, 1 + i) == 0x0900 + i);
+		TEST_CHECK(test_ring_value(ring, 1 + i) == 100 + i);
+	}
+
+	// The frame stores a copy of the payload
+	values[3] = 0;
+	TEST_CHECK(ring.front().restore().payload.ldata.tpdu.info.data.payload[0] == 3);
+
+	ring.release();
+}
+
+static
+void test_frame_coalescing() {
+	uint8_t values[256];
+	for (size_t i = 0; i < 256; i++)
+		values[i] = i;
+
+	FrameRing ring;
+	ring.init(2);
+	ring.set_coalescing(true);
+
+	// Growing keeps the recorded positions valid
+	TEST_CHECK(ring.push(test_frame(0x0801, KNX_APCI_GROUPVALUEWRITE, values + 1, 1)));
+	TEST_CHECK(ring.push(test_frame(0x0802, KNX_APCI_GROUPVALUEWRITE, values + 2, 1)));
+	TEST_CHECK(ring.push(test_frame(0x0803, KNX_APCI_GROUPVALUEWRITE, values + 3, 1)));
+	TEST_CHECK(ring.capacity == 4);
+
+	TEST_CHECK(ring.push(test_frame(0x0802, KNX_APCI_GROUPVALUEWRITE, values + 20, 1)));
+	TEST_CHECK(ring.length == 3);
+	TEST_CHECK(ring.coalesced == 1);
+	TEST_CHECK(test_ring_value(ring, 1) == 20);
+
+	// Reads are never merged
+	TEST_CHECK(ring.push(test_frame(0x0803, KNX_APCI_GROUPVALUEREAD, values, 0)));
+	TEST_CHECK(ring.length == 4);
+	TEST_CHECK(ring.coalesced == 1);
+
+	// A sent frame must not change anymore, the next write to it takes a slot of its own
+	ring.front();
+	ring.seal_front();
+
+	TEST_CHECK(ring.push(test_frame(0x0801, KNX_APCI_GROUPVALUEWRITE, values + 10, 1)));
+	TEST_CHECK(ring.length == 5);
+	TEST_CHECK(test_ring_value(ring, 0) == 1);
+	TEST_CHECK(test_ring_value(ring, 4) == 10);
+
+	// Positions stay valid once frames have been popped and the ring wrapped around and grew
+	ring.pop();
+	ring.pop();
+
+	for (uint16_t i = 0; i < 8; i++)
+		TEST_CHECK(ring.push(test_frame(0x0900 + i, KNX_APCI_GROUPVALUEWRITE, values + 100 + i, 1)));
+
+	TEST_CHECK(ring.length == 11);
+	TEST_CHECK(ring.capacity == 16);
+
+	TEST_CHECK(ring.push(test_frame(0x0803, KNX_APCI_GROUPVALUEWRITE, values + 30, 1)));
+	TEST_CHECK(ring.push(test_frame(0x0801, KNX_APCI_GROUPVALUEWRITE, values + 11, 1)));
+	TEST_CHECK(ring.push(test_frame(0x0905, KNX_APCI_GROUPVALUEWRITE, values + 50, 1)));
+
+	TEST_CHECK(ring.length == 11);
+	TEST_CHECK(ring.coalesced == 4);
+
+	TEST_CHECK(test_ring_destination(ring, 0) == 0x0803);
+	TEST_CHECK(test_ring_value(ring, 0) == 30);
+	TEST_CHECK(test_ring_destination(ring, 2) == 0x0801);
+	TEST_CHECK(test_ring_value(ring, 2) == 11);
+	TEST_CHECK(test_ring_destination(ring, 8) == 0x0905);
+	TEST_CHECK(test_ring_value(ring, 8) == 50);
+
+	// Positions are relative to the head, which no longer is at the start of the slots. Popped
+	// writes are sealed as well.
+	ring.pop();
+	ring.pop();
+	ring.pop();
+
+	TEST_CHECK(ring.head == 3);
+
+	TEST_CHECK(ring.push(test_frame(0x0905, KNX_APCI_GROUPVALUEWRITE, values + 60, 1)));
+	TEST_CHECK(ring.push(test_frame(0x0803, KNX_APCI_GROUPVALUEWRITE, values + 61, 1)));
+	TEST_CHECK(ring.push(test_frame(0x0803, KNX_APCI_GROUPVALUEWRITE, values + 62, 1)));
+
+	TEST_CHECK(ring.length == 9);
+	TEST_CHECK(ring.coalesced == 6);
+
+	TEST_CHECK(test_ring_destination(ring, 5) == 0x0905);
+	TEST_CHECK(test_ring_value(ring, 5) == 60);
+	TEST_CHECK(test_ring_destination(ring, 8) == 0x0803);
+	TEST_CHECK(test_ring_value(ring, 8) == 62);
+
+	ring.release();
+}
+
+// Records what the scheduler hands over and pushes 'follow_up' from within the first hand-over
+struct TestPacing {
+	PacingScheduler* scheduler;
+
+	std::vector<uint16_t> destinations;
+	std::vector<uint8_t> values;
+
+	bool accept;
+	bool pushed;
+	knx_cemi follow_up;
+
+	static
+	bool send(void* data, const knx_cemi* frame) {
+		TestPacing* test = (TestPacing*) data;
+
+		if (!test->pushed) {
+			test->pushed = true;
+			test->scheduler->push(test->follow_up);
+		}
+
+		if (!test->accept) return false;
+
+		test->destinations.push_back(frame->payload.ldata.destination);
+		test->values.push_back(frame->payload.ldata.tpdu.info.data.payload[0]);
+
+		return true;
+	}
+
+	static
+	void timeout(void* data) {}
+};
+
+static
+void test_pacing_reentrancy() {
+	uint8_t values[4] = {0, 1, 2, 3};
+
+	uv_loop_t loop;
+	uv_loop_init(&loop);
+
+	TestPacing test {};
+	test.scheduler = PacingScheduler::create({&TestPacing::send, &TestPacing::timeout}, &test, 1000, 10, &loop);
+	test.scheduler->set_coalescing(true);
+
+	// A frame pushed while another one is handed over is sent once, after it
+	test.accept = true;
+	test.follow_up = test_frame(0x0802, KNX_APCI_GROUPVALUEWRITE, values + 2, 1);
+
+	TEST_CHECK(test.scheduler->push(test_frame(0x0801, KNX_APCI_GROUPVALUEWRITE, values + 1, 1)));
+	TEST_CHECK(test.destinations == std::vector<uint16_t>({0x0801, 0x0802}));
+	TEST_CHECK(test.scheduler->length() == 0);
+
+	// A write to the destination being handed over does not merge into it
+	test.destinations.clear();
+	test.values.clear();
+	test.pushed = false;
+	test.follow_up = test_frame(0x0801, KNX_APCI_GROUPVALUEWRITE, values + 3, 1);
+
+	TEST_CHECK(test.scheduler->push(test_frame(0x0801, KNX_APCI_GROUPVALUEWRITE, values + 1, 1)));
+	TEST_CHECK(test.values == std::vector<uint8_t>({1, 3}));
+	TEST_CHECK(test.scheduler->coalesced() == 0);
+
+	// A frame which was refused takes later writes again
+	test.destinations.clear();
+	test.values.clear();
+	test.accept = false;
+	test.pushed = true;
+
+	TEST_CHECK(test.scheduler->push(test_frame(0x0803, KNX_APCI_GROUPVALUEWRITE, values + 1, 1)));
+	TEST_CHECK(test.scheduler->push(test_frame(0x0803, KNX_APCI_GROUPVALUEWRITE, values + 2, 1)));
+	TEST_CHECK(test.scheduler->length() == 1);
+	TEST_CHECK(test.scheduler->coalesced() == 1);
+
+	test.accept = true;
+	test.scheduler->pump();
+
+	TEST_CHECK(test.values == std::vector<uint8_t>({2}));
+
+	test.scheduler->close();
+	uv_run(&loop, UV_RUN_DEFAULT);
+	uv_loop_close(&loop);
+}
+
+struct TestDelivery {
+	DeliveryBuffer* buffer;
+	uint64_t pushed_at;
+	uint64_t flushed_at;
+	size_t flushed;
+
+	static
+	void flush(void* data) {
+		TestDelivery* test = (TestDelivery*) data;
+
+		test->flushed_at = uv_hrtime();
+		test->flushed += test->buffer->events.size();
+		test->buffer->clear();
+	}
+};
+
+static
+void test_delivery_delay() {
+	uv_loop_t loop;
+	uv_loop_init(&loop);
+
+	TestDelivery test {};
+	test.buffer = DeliveryBuffer::create(&TestDelivery::flush, &test, 100, 2000, &loop);
+
+	// Keeps the loop polling for a while
+	uv_timer_t idle;
+	uv_timer_init(&loop, &idle);
+	uv_timer_start(&idle, [](uv_timer_t*) {}, 200, 0);
+
+	// Close callbacks run after the check phase, the event has to wait for the next turn which
+	// only comes with the timer above unless the delivery buffer wakes the loop itself
+	uv_timer_t trigger;
+	uv_timer_init(&loop, &trigger);
+	trigger.data = &test;
+
+	uv_close((uv_handle_t*) &trigger, [](uv_handle_t* handle) {
+		TestDelivery* test = (TestDelivery*) handle->data;
+
+		test->pushed_at = uv_hrtime();
+		test->buffer->push(ProtocolMessage {PROTOCOL_ABANDON, {0x0801, 0}, {}});
+	});
+
+	uv_run(&loop, UV_RUN_DEFAULT);
+
+	TEST_CHECK(test.flushed == 1);
+	TEST_CHECK(test.flushed_at - test.pushed_at < 100000000);
+
+	test.buffer->close();
+	uv_close((uv_handle_t*) &idle, nullptr);
+
+	uv_run(&loop, UV_RUN_DEFAULT);
+	uv_loop_close(&loop);
+}
+
+static
+void test_rtt_estimator() {
+	RttEstimator rtt;
+
+	// The initial timeout is clamped, too
+	rtt.init(10000, 10, 4000);
+	TEST_CHECK(!rtt.measured);
+	TEST_CHECK(rtt.timeout() == 4000);
+
+	rtt.init(1000, 10, 4000);
+	TEST_CHECK(rtt.timeout() == 1000);
+
+	// RFC 6298: SRTT = R, RTTVAR = R/2, RTO = SRTT + 4 RTTVAR
+	rtt.sample(100);
+	TEST_CHECK(rtt.measured);
+	TEST_CHECK(rtt.srtt == 100);
+	TEST_CHECK(rtt.rttvar == 50);
+	TEST_CHECK(rtt.timeout() == 300);
+
+	// RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|, SRTT = 7/8 SRTT + 1/8 R
+	rtt.sample(200);
+	TEST_CHECK(rtt.rttvar == 62.5);
+	TEST_CHECK(rtt.srtt == 112.5);
+	TEST_CHECK(rtt.timeout() == 363);
+
+	rtt.backoff();
+	TEST_CHECK(rtt.timeout() == 725);
+
+	for (int i = 0; i < 8; i++)
+		rtt.backoff();
+
+	TEST_CHECK(rtt.timeout() == 4000);
+
+	// Fast round trips hit the lower bound
+	rtt.init(1000, 10, 4000);
+	rtt.sample(1);
+	TEST_CHECK(rtt.timeout() == 10);
+
+	// Fractions round up to whole milliseconds
+	rtt.init(1000, 0, 4000);
+	rtt.sample(0.3);
+	TEST_CHECK(rtt.timeout() == 1);
+}
+
+static
+void test_latency_histogram() {
+	using H = LatencyHistogram;
+
+	// Small values have exact buckets
+	for (uint64_t value = 0; value < H::sub_buckets; value++) {
+		TEST_CHECK(H::bucket_of(value) == value);
+		TEST_CHECK(H::bucket_floor(value) == value);
+	}
+
+	// Every value lies between the floor of its bucket and the floor of the next one, and buckets
+	// are no wider than 1/16 of their floor
+	std::vector<uint64_t> values;
+
+	for (size_t bit = 0; bit < H::max_bits; bit++) {
+		uint64_t base = uint64_t(1) << bit;
+
+		for (uint64_t delta: {uint64_t(0), uint64_t(1), base / 3, base / 2, base - 1})
+			values.push_back(base + delta);
+	}
+
+	for (uint64_t value: values) {
+		size_t bucket = H::bucket_of(value);
+
+		TEST_CHECK(bucket < H::bucket_count);
+		TEST_CHECK(H::bucket_floor(bucket) <= value);
+
+		if (bucket + 1 < H::bucket_count) {
+			TEST_CHECK(value < H::bucket_floor(bucket + 1));
+			TEST_CHECK(H::bucket_floor(bucket + 1) - H::bucket_floor(bucket) <= std::max<uint64_t>(1, H::bucket_floor(bucket) / H::sub_buckets));
+		}
+	}
+
+	// Buckets are ordered
+	for (size_t bucket = 1; bucket < H::bucket_count; bucket++)
+		TEST_CHECK(H::bucket_floor(bucket - 1) < H::bucket_floor(bucket));
+
+	// Values beyond the range are clamped to the last bucket
+	TEST_CHECK(H::bucket_of(uint64_t(1) << H::max_bits) == H::bucket_count - 1);
+	TEST_CHECK(H::bucket_of(UINT64_MAX) == H::bucket_count - 1);
+
+	LatencyHistogram empty;
+	TEST_CHECK(empty.percentile(50) == 0);
+
+	LatencyHistogram histogram;
+	for (uint64_t value = 1; value <= 1000; value++)
+		histogram.record(value);
+
+	TEST_CHECK(histogram.count == 1000);
+	TEST_CHECK(histogram.min == 1);
+	TEST_CHECK(histogram.max == 1000);
+
+	// Percentiles report the upper end of their bucket, hence at most 1/16 above the exact value
+	uint64_t p50 = histogram.percentile(50);
+	uint64_t p99 = histogram.percentile(99);
+
+	TEST_CHECK(p50 >= 500 && p50 <= 500 + 500 / 16);
+	TEST_CHECK(p99 >= 990 && p99 <= 1000);
+	TEST_CHECK(histogram.percentile(100) == 1000);
+}
+
+// Straight from the definition of DPT 9
+static
+double test_float16_reference(uint16_t raw) {
+	int32_t mantissa = raw & 0x7FF;
+	if (raw & 0x8000) mantissa -= 2048;
+
+	return 0.01 * mantissa * std::ldexp(1.0, (raw >> 11) & 15);
+}
+
+static
+void test_float16_codecs() {
+	std::vector<uint8_t> raw(65536 * 2);
+	std::vector<uint8_t> spaced(65536 * 3);
+
+	for (size_t i = 0; i < 65536; i++) {
+		raw[i * 2] = spaced[i * 3] = i >> 8;
+		raw[i * 2 + 1] = spaced[i * 3 + 1] = i & 255;
+	}
+
+	// The vectorized paths only take densely packed values, both have to match the definition
+	std::vector<double> decoded(65536);
+	std::vector<double> decoded_spaced(65536);
+
+	knxproto_bulk_decode_float16(raw.data(), 2, 65536, decoded.data());
+	knxproto_bulk_decode_float16(spaced.data(), 3, 65536, decoded_spaced.data());
+
+	int mismatches = 0;
+
+	for (size_t i = 0; i < 65536; i++)
+		if (decoded[i] != test_float16_reference(i) || decoded_spaced[i] != decoded[i])
+			mismatches++;
+
+	TEST_CHECK(mismatches == 0);
+
+	// Counts which are no multiple of the vector width leave a scalar tail
+	double tail[11];
+	knxproto_bulk_decode_float16(raw.data() + 2 * 1000, 2, 11, tail);
+
+	for (size_t i = 0; i < 11; i++)
+		TEST_CHECK(tail[i] == test_float16_reference(1000 + i));
+
+	// Encoding rounds to the nearest representable value
+	const double inputs[] = {0, 0.01, -0.01, 21.5, -273, 1013.25, 20.48, -20.48, 670760.96, -671088.64};
+	const size_t count = sizeof(inputs) / sizeof(double);
+
+	uint8_t encoded[count * 2];
+	knxproto_bulk_encode_float16(inputs, count, encoded);
+
+	double round_trip[count];
+	knxproto_bulk_decode_float16(encoded, 2, count, round_trip);
+
+	for (size_t i = 0; i < count; i++) {
+		uint16_t value = uint16_t(encoded[i * 2] << 8 | encoded[i * 2 + 1]);
+		double resolution = 0.01 * std::ldexp(1.0, (value >> 11) & 15);
+
+		TEST_CHECK(std::fabs(round_trip[i] - inputs[i]) <= resolution / 2);
+	}
+
+	// Out of range values saturate, NaN is the invalid value
+	const double special[] = {NAN, INFINITY, -INFINITY, 1e12, -1e12};
+	uint8_t special_encoded[10];
+
+	knxproto_bulk_encode_float16(special, 5, special_encoded);
+
+	const uint16_t special_expected[] = {0x7FFF, 0x7FFF, 0xF800, 0x7FFF, 0xF800};
+
+	for (size_t i = 0; i < 5; i++)
+		TEST_CHECK(uint16_t(special_encoded[i * 2] << 8 | special_encoded[i * 2 + 1]) == special_expected[i]);
+}
+
+// Values around the edges of each encoding: rounding midpoints, exponent changes, saturation
+static
+std::vector<double> test_encode_inputs() {
+	std::vector<double> inputs = {0, -0.0, NAN, -NAN, INFINITY, -INFINITY, 1e300, -1e300, 5e-324, 65535, 65535.5, 65536};
+
+	for (int exponent = 0; exponent <= 16; exponent++) {
+		double unit = 0.01 * std::ldexp(1.0, exponent);
+
+		for (double mantissa: {2047.0, 2047.5, 2048.0, 1024.5, 0.5, 1.5, 2.5, -2048.0, -2048.5, -2049.0, -0.5, -1.5})
+			for (double nudge: {-1e-9, 0.0, 1e-9})
+				inputs.push_back(mantissa * unit + nudge);
+	}
+
+	uint32_t state = 1;
+
+	for (size_t i = 0; i < 4096; i++) {
+		state = state * 1664525 + 1013904223;
+		inputs.push_back(std::ldexp(double(int32_t(state)), int(i % 40) - 40));
+	}
+
+	return inputs;
+}
+
+// The vectorized encoders have to agree with the scalar tail, which a count of one always takes
+static
+void test_bulk_encoders() {
+	std::vector<double> inputs = test_encode_inputs();
+	size_t count = inputs.size();
+
+	std::vector<uint8_t> bulk(count * 4);
+	uint8_t single[4];
+
+	int mismatches = 0;
+	knxproto_bulk_encode_float16(inputs.data(), count, bulk.data());
+
+	for (size_t i = 0; i < count; i++) {
+		knxproto_bulk_encode_float16(&inputs[i], 1, single);
+		mismatches += std::equal(single, single + 2, bulk.data() + i * 2) ? 0 : 1;
+	}
+
+	TEST_CHECK(mismatches == 0);
+
+	mismatches = 0;
+	knxproto_bulk_encode_unsigned16(inputs.data(), count, bulk.data());
+
+	for (size_t i = 0; i < count; i++) {
+		knxproto_bulk_encode_unsigned16(&inputs[i], 1, single);
+		mismatches += std::equal(single, single + 2, bulk.data() + i * 2) ? 0 : 1;
+	}
+
+	TEST_CHECK(mismatches == 0);
+
+	mismatches = 0;
+	knxproto_bulk_encode_float32(inputs.data(), count, bulk.data());
+
+	for (size_t i = 0; i < count; i++) {
+		knxproto_bulk_encode_float32(&inputs[i], 1, single);
+		mismatches += std::equal(single, single + 4, bulk.data() + i * 4) ? 0 : 1;
+	}
+
+	TEST_CHECK(mismatches == 0);
+
+	// Decoding what was just encoded takes the vectorized float32 path
+	std::vector<double> decoded(count);
+	knxproto_bulk_decode_float32(bulk.data(), 4, count, decoded.data());
+
+	mismatches = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		double value;
+		knxproto_bulk_decode_float32(bulk.data() + i * 4, 4, 1, &value);
+
+		if (std::memcmp(&value, &decoded[i], sizeof(value)) != 0 ||
+		    (!std::isnan(inputs[i]) && value != double(float(inputs[i]))))
+			mismatches++;
+	}
+
+	TEST_CHECK(mismatches == 0);
+}
+
+static
+std::vector<uint8_t> test_record(uint32_t index) {
+	std::vector<uint8_t> record(1 + index * 37 % 1500);
+
+	for (size_t i = 0; i < record.size(); i++)
+		record[i] = uint8_t(index + i);
+
+	return record;
+}
+
+static
+void test_capture_round_trip() {
+	char directory[] = "/tmp/knxproto_test.XXXXXX";
+
+	if (!mkdtemp(directory)) {
+		TEST_CHECK(!"mkdtemp failed");
+		return;
+	}
+
+	std::string prefix = std::string(directory) + "/log";
+
+	// The minimum segment size fits one record of maximum length, these records take several
+	CaptureLog* log = CaptureLog::open(prefix, 0, 0);
+	TEST_CHECK(log != nullptr);
+	if (!log) return;
+
+	const uint32_t records = 400;
+
+	for (uint32_t i = 0; i < records; i++) {
+		std::vector<uint8_t> record = test_record(i);
+		CaptureDirection direction = i % 3 == 0 ? CAPTURE_OUTBOUND : CAPTURE_INBOUND;
+
+		TEST_CHECK(log->append(1000 + i, direction, record.data(), record.size()));
+	}
+
+	// Zero timestamps terminate a segment and are refused
+	TEST_CHECK(!log->append(0, CAPTURE_INBOUND, nullptr, 0));
+	TEST_CHECK(log->records == records);
+	TEST_CHECK(log->dropped == 1);
+
+	log->close();
+
+	std::vector<uint32_t> segments = capture_segments(prefix);
+	TEST_CHECK(segments.size() > 1);
+
+	CaptureReader* reader = CaptureReader::open(prefix);
+	TEST_CHECK(reader != nullptr);
+	if (!reader) return;
+
+	CaptureEntry entry;
+	uint32_t read = 0;
+
+	for (; reader->next(entry); read++) {
+		std::vector<uint8_t> record = test_record(read);
+
+		TEST_CHECK(entry.timestamp == 1000 + read);
+		TEST_CHECK(entry.direction == (read % 3 == 0 ? CAPTURE_OUTBOUND : CAPTURE_INBOUND));
+		TEST_CHECK(entry.length == record.size());
+		TEST_CHECK(std::equal(record.begin(), record.end(), entry.data));
+	}
+
+	TEST_CHECK(read == records);
+
+	delete reader;
+
+	// An earlier capture is never overwritten
+	TEST_CHECK(CaptureLog::open(prefix, 0, 0) == nullptr);
+	TEST_CHECK(capture_segments(prefix) == segments);
+
+	// With a limit on the number of segments, the oldest ones are dropped and the rest reads in order
+	std::string limited = std::string(directory) + "/limited";
+
+	log = CaptureLog::open(limited, 0, 2);
+	TEST_CHECK(log != nullptr);
+	if (!log) return;
+
+	for (uint32_t i = 0; i < records; i++) {
+		std::vector<uint8_t> record = test_record(i);
+		log->append(1000 + i, CAPTURE_INBOUND, record.data(), record.size());
+	}
+
+	log->close();
+
+	TEST_CHECK(capture_segments(limited).size() == 2);
+
+	reader = CaptureReader::open(limited);
+	TEST_CHECK(reader != nullptr);
+	if (!reader) return;
+
+	uint64_t previous = 0;
+	read = 0;
+
+	for (; reader->next(entry); read++) {
+		TEST_CHECK(entry.timestamp > previous);
+		TEST_CHECK(entry.length == test_record(entry.timestamp - 1000).size());
+
+		previous = entry.timestamp;
+	}
+
+	TEST_CHECK(read > 0 && read < records);
+	TEST_CHECK(previous == 1000 + records - 1);
+
+	delete reader;
+
+	for (const std::string& name: {prefix, limited}) {
+		for (uint32_t index: capture_segments(name))
+			unlink(capture_segment_path(name, index).c_str());
+	}
+
+	rmdir(directory);
+}
+
+int main(int argc, char** argv) {
+	struct {
+		const char* name;
+		void (* run)();
+	} tests[] = {
+		{"frame_ring",        &test_frame_ring},
+		{"frame_coalescing",  &test_frame_coalescing},
+		{"pacing_reentrancy", &test_pacing_reentrancy},
+		{"delivery_delay",    &test_delivery_delay},
+		{"float16_codecs",    &test_float16_codecs},
+		{"bulk_encoders",     &test_bulk_encoders},
+		{"latency_histogram", &test_latency_histogram},
+		{"rtt_estimator",     &test_rtt_estimator},
+		{"capture",           &test_capture_round_trip}
+	};
+
+	for (const auto& test: tests) {
+		int before = test_failures;
+		test.run();
+
+		std::printf("%-20s %s\n", test.name, test_failures == before ? "ok" : "FAILED");
+	}
+
+	return test_failures == 0 ? 0 : 1;
+}